@@ -0,0 +1,54 @@
+#!/bin/bash
+# Compares the target fast model against the full transport: throughput and
+# eDep spectra.
+#
+#   bench/compare_fast_target.sh [events] [threads] [workdir]
+#
+# Run from the directory exampleB1 is normally run from (the generator reads
+# work/generated_data_2p.csv), with exampleB1, compare_edep and
+# validate_output in BUILD_DIR (default: ./build). Both modes run the same
+# fixed-seed macro with PHYSICS_LIST (default: QBBC). The rms columns of
+# compare_edep compare the widths of the spectra, which carry the energy-loss
+# straggling in the target. Exits with the status of validate_output, whose
+# report is written to <workdir>/validation.txt; VALIDATE_ARGS passes
+# tolerances.
+
+set -e
+
+EVENTS=${1:-100000}
+THREADS=${2:-4}
+WORKDIR=${3:-work/fastTargetBench}
+BUILD_DIR=${BUILD_DIR:-build}
+PHYSICS_LIST=${PHYSICS_LIST:-QBBC}
+
+mkdir -p "$WORKDIR"
+MACRO="$WORKDIR/bench.mac"
+cat > "$MACRO" <<MAC
+/run/numberOfThreads $THREADS
+/run/initialize
+/random/setSeeds 12345 67890
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+
+printf "%-8s %10s %10s %12s\n" "mode" "events" "wall[s]" "events/s"
+for mode in full fast; do
+  out="$WORKDIR/$mode"
+  rm -rf "$out"
+  mkdir -p "$out"
+  args=""
+  if [ "$mode" = fast ]; then
+    args="--fast-target"
+  fi
+  start=$(date +%s.%N)
+  "$BUILD_DIR/exampleB1" -p "$PHYSICS_LIST" $args -o "$out" "$MACRO" > "$out/log.txt" 2>&1
+  end=$(date +%s.%N)
+  awk -v l="$mode" -v n="$EVENTS" -v s="$start" -v e="$end" \
+    'BEGIN { printf "%-8s %10d %10.1f %12.1f\n", l, n, e - s, n / (e - s) }'
+done
+
+echo
+"$BUILD_DIR/compare_edep" "$WORKDIR/full" "$WORKDIR/fast"
+
+echo
+"$BUILD_DIR/validate_output" "$WORKDIR/full" "$WORKDIR/fast" --report "$WORKDIR/validation.txt" $VALIDATE_ARGS
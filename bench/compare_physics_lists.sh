@@ -0,0 +1,46 @@
+#!/bin/bash
+# Compares the lean physics list against QBBC: throughput and eDep spectra.
+#
+#   bench/compare_physics_lists.sh [events] [threads] [workdir]
+#
+# Run from the directory exampleB1 is normally run from (the generator reads
+# work/generated_data_2p.csv), with exampleB1, compare_edep and
+# validate_output in BUILD_DIR (default: ./build). Both lists run the same
+# fixed-seed macro. Exits with the status of validate_output, whose report
+# is written to <workdir>/validation.txt; VALIDATE_ARGS passes tolerances.
+
+set -e
+
+EVENTS=${1:-100000}
+THREADS=${2:-4}
+WORKDIR=${3:-work/physicsBench}
+BUILD_DIR=${BUILD_DIR:-build}
+LISTS="QBBC lean"
+
+mkdir -p "$WORKDIR"
+MACRO="$WORKDIR/bench.mac"
+cat > "$MACRO" <<EOF
+/run/numberOfThreads $THREADS
+/run/initialize
+/random/setSeeds 12345 67890
+/run/printProgress 0
+/run/beamOn $EVENTS
+EOF
+
+printf "%-8s %10s %10s %12s\n" "list" "events" "wall[s]" "events/s"
+for list in $LISTS; do
+  out="$WORKDIR/$list"
+  rm -rf "$out"
+  mkdir -p "$out"
+  start=$(date +%s.%N)
+  "$BUILD_DIR/exampleB1" -p "$list" -o "$out" "$MACRO" > "$out/log.txt" 2>&1
+  end=$(date +%s.%N)
+  awk -v l="$list" -v n="$EVENTS" -v s="$start" -v e="$end" \
+    'BEGIN { printf "%-8s %10d %10.1f %12.1f\n", l, n, e - s, n / (e - s) }'
+done
+
+echo
+"$BUILD_DIR/compare_edep" "$WORKDIR/QBBC" "$WORKDIR/lean"
+
+echo
+"$BUILD_DIR/validate_output" "$WORKDIR/QBBC" "$WORKDIR/lean" --report "$WORKDIR/validation.txt" $VALIDATE_ARGS
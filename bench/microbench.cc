@@ -0,0 +1,232 @@
+/// \file B1/bench/microbench.cc
+/// \brief Microbenchmarks of the application hot paths
+///
+/// Exercises the generator, event and run actions in isolation, without a
+/// run manager or a Geant4 job:
+///
+///   octupole_microbench [--benchmark_filter=<regex>] [google benchmark options]
+///
+/// Temporary input and output files are written to $TMPDIR (default /tmp).
+
+#include "EventAction.hh"
+#include "ExpConstants.hh"
+#include "InitParticleEventInfo.hh"
+#include "ProtonGenerator.hh"
+#include "RunAction.hh"
+
+#include "G4Event.hh"
+#include "G4ThreeVector.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+  std::string TempPath(const std::string &name)
+  {
+    const char *dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp") + "/octupole_microbench_" + std::to_string(getpid()) + "_" + name;
+  }
+
+  /// Generator input in the format of work/generated_data_2p.csv
+  std::string WriteGeneratorInput(int rows)
+  {
+    const std::string fname = TempPath("input.csv");
+    std::ofstream fout(fname);
+    fout << "deg_lab,en_p,phi,z,x,y\n";
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    for (int i = 0; i < rows; ++i)
+    {
+      fout << 180. * uniform(rng) << "," << 20. * uniform(rng) << "," << 2. * M_PI * uniform(rng) << ","
+           << 0.05 * uniform(rng) << "," << 30. * (uniform(rng) - 0.5) << "," << 30. * (uniform(rng) - 0.5)
+           << "\n";
+    }
+    return fname;
+  }
+
+  /// Step in one of the detectors: 0 front Si, 1 Si strip, 2 CsI
+  struct SyntheticStep
+  {
+    int detector;
+    int copyNum;
+    double eDep;
+  };
+
+  /// Steps of nEvents events with stepsPerEvent steps each. A proton
+  /// crosses the front Si, a few neighbouring strips and one CsI crystal.
+  std::vector<SyntheticStep> MakeStepStream(int nEvents, int stepsPerEvent)
+  {
+    std::vector<SyntheticStep> steps;
+    steps.reserve(static_cast<size_t>(nEvents) * stepsPerEvent);
+    std::mt19937_64 rng(67890);
+    std::uniform_int_distribution<int> strip(0, B1::kNSiStrips - 4);
+    std::uniform_int_distribution<int> crystal(0, 3);
+    std::uniform_real_distribution<double> eDep(0., 0.1);
+    for (int evt = 0; evt < nEvents; ++evt)
+    {
+      const int firstStrip = strip(rng);
+      const int csi = crystal(rng);
+      for (int i = 0; i < stepsPerEvent; ++i)
+      {
+        const int detector = i < 2 ? 0 : (i < stepsPerEvent / 2 ? 1 : 2);
+        const int copyNum = detector == 1 ? firstStrip + i % 4 : (detector == 2 ? csi : 0);
+        steps.push_back({detector, copyNum, eDep(rng)});
+      }
+    }
+    return steps;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void BM_ProtonGeneratorReadFile(benchmark::State &state)
+  {
+    const std::string fname = WriteGeneratorInput(state.range(0));
+    ProtonGenerator generator;
+    for (auto _ : state)
+    {
+      generator.ReadFile(fname);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(fname.c_str());
+  }
+  BENCHMARK(BM_ProtonGeneratorReadFile)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+  void BM_ProtonGeneratorSetParticle(benchmark::State &state)
+  {
+    const std::string fname = WriteGeneratorInput(100000);
+    ProtonGenerator generator;
+    generator.ReadFile(fname);
+    G4ThreeVector direction, position;
+    double energy;
+    for (auto _ : state)
+    {
+      generator.SetParticle(direction, energy, position);
+      benchmark::DoNotOptimize(energy);
+    }
+    state.SetItemsProcessed(state.iterations());
+    std::remove(fname.c_str());
+  }
+  BENCHMARK(BM_ProtonGeneratorSetParticle);
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  /// Replays a synthetic step stream through the event action, one
+  /// iteration per event, including EndOfEventAction's hand-over to the run
+  /// action.
+  void BM_EventActionSteps(benchmark::State &state)
+  {
+    const int nEvents = 1000;
+    const int stepsPerEvent = state.range(0);
+    const auto steps = MakeStepStream(nEvents, stepsPerEvent);
+
+    auto runAction = std::make_shared<B1::RunAction>(TempPath("output"));
+    B1::EventAction eventAction(runAction.get());
+    G4Event event;
+    event.SetUserInformation(new InitParticleEventInfo(10., 1., 0.5));
+
+    int evt = 0;
+    for (auto _ : state)
+    {
+      // keep the builders from growing without bound
+      if (evt % nEvents == 0)
+      {
+        state.PauseTiming();
+        runAction->InitializeBuilders(0);
+        state.ResumeTiming();
+      }
+      eventAction.BeginOfEventAction(&event);
+      const auto *step = &steps[static_cast<size_t>(evt % nEvents) * stepsPerEvent];
+      for (int i = 0; i < stepsPerEvent; ++i, ++step)
+      {
+        if (step->detector == 0)
+          eventAction.AddFrontEdep(step->eDep);
+        else if (step->detector == 1)
+          eventAction.AddSiEdep(step->eDep, step->copyNum);
+        else
+          eventAction.AddCsIEdep(step->eDep, step->copyNum);
+      }
+      eventAction.EndOfEventAction(&event);
+      ++evt;
+    }
+    state.SetItemsProcessed(state.iterations() * stepsPerEvent);
+    state.counters["events/s"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+  }
+  BENCHMARK(BM_EventActionSteps)->Arg(10)->Arg(100)->Arg(1000);
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void BM_RunActionAddEdep(benchmark::State &state)
+  {
+    B1::RunAction runAction(TempPath("output"));
+    runAction.InitializeBuilders(0);
+    int copyNum = 0;
+    for (auto _ : state)
+    {
+      runAction.AddEdep("Si", 0.5, copyNum);
+      copyNum = (copyNum + 1) % B1::kNSiStrips;
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_RunActionAddEdep);
+
+  void BM_RunActionAddEventInfo(benchmark::State &state)
+  {
+    B1::RunAction runAction(TempPath("output"));
+    runAction.InitializeBuilders(0);
+    int64_t eventId = 0;
+    for (auto _ : state)
+    {
+      runAction.AddEventInfo(10., 1., 0.5);
+      runAction.IncrementEvent();
+      runAction.SetEventId(++eventId);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_RunActionAddEventInfo);
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  /// Finalize and write of state.range(0) hits (one event per 5 hits), as
+  /// at the end of a worker's run. Filling the builders is not timed.
+  void BM_RunActionWriteTables(benchmark::State &state)
+  {
+    const int64_t nHits = state.range(0);
+    const std::string eDepFile = TempPath("eDep.parquet");
+    const std::string evtInfoFile = TempPath("evtInfo.parquet");
+    B1::RunAction runAction(TempPath("output"));
+    for (auto _ : state)
+    {
+      state.PauseTiming();
+      runAction.InitializeBuilders(0);
+      for (int64_t i = 0; i < nHits; ++i)
+      {
+        runAction.AddEdep(i % 5 ? "Si" : "CsI", 0.5, i % B1::kNSiStrips);
+        if (i % 5 == 4)
+        {
+          runAction.AddEventInfo(10., 1., 0.5);
+          runAction.SetEventId(i / 5 + 1);
+        }
+      }
+      state.ResumeTiming();
+      runAction.WriteTables(eDepFile, evtInfoFile);
+    }
+    state.SetItemsProcessed(state.iterations() * nHits);
+    std::remove(eDepFile.c_str());
+    std::remove(evtInfoFile.c_str());
+  }
+  BENCHMARK(BM_RunActionWriteTables)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond)->Iterations(5);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,312 @@
+/// \file B1/bench/query_layout.cc
+/// \brief Row-group and page skipping of typical queries on the eDep output
+///
+///   octupole_query_bench <prefix> [--events first:last] [--lookup eventId]
+///                        [--detector name] [--copy id] [--repeat n]
+///
+/// Evaluates each query on the eDep files below the prefix (shards and run
+/// partitions included) the way a Parquet reader with predicate pushdown
+/// does: row groups whose min/max statistics exclude the predicate are
+/// skipped, a single-event lookup also asks the bloom filter of eventId, and
+/// inside the remaining row groups the column index skips the eventId pages
+/// outside the range. Prints per query the fraction of row groups, rows and
+/// eventId pages read, and the best of n times to read the kept row groups
+/// against reading every file in full.
+///
+/// The queries are an eventId range (default: 1% of the events in the
+/// middle of the run), a lookup of one event (default: the middle one), a
+/// detector and a detector with a copy ID (default: Si and copy 0). Output
+/// written with the default layout shows what a reader scans without the
+/// sorted layout of --sort, see bench/query_layout.sh.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/bloom_filter.h>
+#include <parquet/bloom_filter_reader.h>
+#include <parquet/exception.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/page_index.h>
+#include <parquet/statistics.h>
+#include <parquet/types.h>
+
+#include "DatasetFiles.hh"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+  struct Query
+  {
+    std::string name;
+    bool hasEvents = false;
+    int64_t firstEvent = 0;
+    int64_t lastEvent = 0;
+    bool lookup = false;
+    std::string detector;
+    bool hasCopy = false;
+    int32_t copy = 0;
+  };
+
+  struct Counts
+  {
+    int64_t rowGroups = 0, keptRowGroups = 0, bloomSkipped = 0;
+    int64_t rows = 0, keptRows = 0;
+    int64_t pages = 0, keptPages = 0;
+  };
+
+  template <typename Stats>
+  std::shared_ptr<Stats> MinMax(const parquet::RowGroupMetaData &rowGroup, int column)
+  {
+    if (column < 0)
+      return nullptr;
+    const auto stats = rowGroup.ColumnChunk(column)->statistics();
+    if (!stats || !stats->HasMinMax())
+      return nullptr;
+    return std::static_pointer_cast<Stats>(stats);
+  }
+
+  /// Whether the statistics of the row group admit rows of the query; a
+  /// column without statistics admits everything
+  bool Admits(const Query &query, const parquet::RowGroupMetaData &rowGroup, int eventCol, int detCol, int copyCol)
+  {
+    if (query.hasEvents)
+    {
+      const auto events = MinMax<parquet::Int64Statistics>(rowGroup, eventCol);
+      if (events && (events->max() < query.firstEvent || events->min() > query.lastEvent))
+        return false;
+    }
+    if (!query.detector.empty())
+    {
+      const auto names = MinMax<parquet::ByteArrayStatistics>(rowGroup, detCol);
+      if (names && (parquet::ByteArrayToString(names->max()) < query.detector ||
+                    parquet::ByteArrayToString(names->min()) > query.detector))
+        return false;
+    }
+    if (query.hasCopy)
+    {
+      const auto copies = MinMax<parquet::Int32Statistics>(rowGroup, copyCol);
+      if (copies && (copies->max() < query.copy || copies->min() > query.copy))
+        return false;
+    }
+    return true;
+  }
+
+  /// Evaluates the query on a file and returns the row groups to read
+  std::vector<int> Plan(const Query &query, parquet::ParquetFileReader &reader, Counts &counts)
+  {
+    const auto metadata = reader.metadata();
+    const auto schema = metadata->schema();
+    const int eventCol = schema->ColumnIndex("eventId");
+    const int detCol = schema->ColumnIndex("detName");
+    const int copyCol = schema->ColumnIndex("copyId");
+    const auto pageIndex = reader.GetPageIndexReader();
+
+    std::vector<int> kept;
+    for (int i = 0; i < metadata->num_row_groups(); ++i)
+    {
+      const auto rowGroup = metadata->RowGroup(i);
+      // pages of eventId in the row group, from the column index
+      const auto rowGroupIndex = pageIndex && eventCol >= 0 ? pageIndex->RowGroup(i) : nullptr;
+      const auto columnIndex = rowGroupIndex ? std::static_pointer_cast<parquet::Int64ColumnIndex>(
+                                                   rowGroupIndex->GetColumnIndex(eventCol))
+                                             : nullptr;
+      ++counts.rowGroups;
+      counts.rows += rowGroup->num_rows();
+      if (columnIndex)
+        counts.pages += columnIndex->null_pages().size();
+
+      if (!Admits(query, *rowGroup, eventCol, detCol, copyCol))
+        continue;
+      if (query.lookup && eventCol >= 0)
+      {
+        const auto bloomFilters = reader.GetBloomFilterReader().RowGroup(i);
+        const auto filter = bloomFilters ? bloomFilters->GetColumnBloomFilter(eventCol) : nullptr;
+        if (filter && !filter->FindHash(filter->Hash(query.firstEvent)))
+        {
+          ++counts.bloomSkipped;
+          continue;
+        }
+      }
+      kept.push_back(i);
+      ++counts.keptRowGroups;
+      counts.keptRows += rowGroup->num_rows();
+      if (!columnIndex)
+        continue;
+      const auto &nullPages = columnIndex->null_pages();
+      for (size_t page = 0; page < nullPages.size(); ++page)
+      {
+        if (!nullPages[page] && (!query.hasEvents || (columnIndex->max_values()[page] >= query.firstEvent &&
+                                                      columnIndex->min_values()[page] <= query.lastEvent)))
+          ++counts.keptPages;
+      }
+    }
+    return kept;
+  }
+
+  /// Seconds to read the row groups of every file, all of them if rowGroups is null
+  double ReadSeconds(const std::vector<fs::path> &files, const std::vector<std::vector<int>> *rowGroups)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < files.size(); ++f)
+    {
+      if (rowGroups && (*rowGroups)[f].empty())
+        continue;
+      std::shared_ptr<arrow::io::ReadableFile> infile;
+      PARQUET_ASSIGN_OR_THROW(infile, arrow::io::ReadableFile::Open(files[f].string()));
+      std::unique_ptr<parquet::arrow::FileReader> reader;
+      PARQUET_THROW_NOT_OK(parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
+      std::shared_ptr<arrow::Table> table;
+      if (rowGroups)
+        PARQUET_THROW_NOT_OK(reader->ReadRowGroups((*rowGroups)[f], &table));
+      else
+        PARQUET_THROW_NOT_OK(reader->ReadTable(&table));
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  double Percent(int64_t part, int64_t total) { return total > 0 ? 100. * part / total : 0.; }
+
+  void PrintUsage(const char *program)
+  {
+    std::cerr << "Usage: " << program
+              << " <prefix> [--events first:last] [--lookup eventId] [--detector name] [--copy id] [--repeat n]"
+              << std::endl;
+  }
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  const std::string prefix = argv[1];
+  Query range{"eventId range"}, lookup{"eventId lookup"}, detector{"detName"}, copy{"detName, copyId"};
+  range.hasEvents = lookup.hasEvents = lookup.lookup = true;
+  bool userRange = false, userLookup = false;
+  std::string detName = "Si";
+  int32_t copyId = 0;
+  int repeat = 3;
+  for (int i = 2; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(arg, "--events") && hasValue &&
+        std::sscanf(argv[++i], "%ld:%ld", &range.firstEvent, &range.lastEvent) == 2)
+    {
+      userRange = true;
+    }
+    else if (!std::strcmp(arg, "--lookup") && hasValue)
+    {
+      lookup.firstEvent = lookup.lastEvent = std::atol(argv[++i]);
+      userLookup = true;
+    }
+    else if (!std::strcmp(arg, "--detector") && hasValue)
+    {
+      detName = argv[++i];
+    }
+    else if (!std::strcmp(arg, "--copy") && hasValue)
+    {
+      copyId = std::atoi(argv[++i]);
+    }
+    else if (!std::strcmp(arg, "--repeat") && hasValue)
+    {
+      repeat = std::max(std::atoi(argv[++i]), 1);
+    }
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  detector.detector = copy.detector = detName;
+  copy.hasCopy = true;
+  copy.copy = copyId;
+
+  std::vector<fs::path> files;
+  std::vector<std::unique_ptr<parquet::ParquetFileReader>> readers;
+  int64_t minEvent = std::numeric_limits<int64_t>::max(), maxEvent = std::numeric_limits<int64_t>::min();
+  for (const auto &entry : fs::recursive_directory_iterator(prefix))
+  {
+    if (!tables::InTable(entry.path(), "eDep"))
+      continue;
+    auto reader = parquet::ParquetFileReader::OpenFile(entry.path().string());
+    const auto metadata = reader->metadata();
+    const int eventCol = metadata->schema()->ColumnIndex("eventId");
+    for (int i = 0; i < metadata->num_row_groups(); ++i)
+    {
+      const auto events = MinMax<parquet::Int64Statistics>(*metadata->RowGroup(i), eventCol);
+      if (events)
+      {
+        minEvent = std::min(minEvent, events->min());
+        maxEvent = std::max(maxEvent, events->max());
+      }
+    }
+    files.push_back(entry.path());
+    readers.push_back(std::move(reader));
+  }
+  if (files.empty() || minEvent > maxEvent)
+  {
+    std::cerr << "No eDep files with eventId statistics below " << prefix << std::endl;
+    return 1;
+  }
+  if (!userRange)
+  {
+    const int64_t width = std::max<int64_t>((maxEvent - minEvent + 1) / 100, 1);
+    range.firstEvent = minEvent + (maxEvent - minEvent + 1 - width) / 2;
+    range.lastEvent = range.firstEvent + width - 1;
+  }
+  if (!userLookup)
+    lookup.firstEvent = lookup.lastEvent = minEvent + (maxEvent - minEvent) / 2;
+
+  double fullSeconds = std::numeric_limits<double>::max();
+  for (int r = 0; r < repeat; ++r)
+    fullSeconds = std::min(fullSeconds, ReadSeconds(files, nullptr));
+
+  std::printf("%zu eDep files, events %ld to %ld, full read %.1f ms\n\n", files.size(), minEvent, maxEvent,
+              fullSeconds * 1e3);
+  std::printf("%-18s %-24s %16s %8s %8s %14s %10s %8s\n", "query", "predicate", "row groups", "bloom", "rows",
+              "eventId pages", "read[ms]", "speedup");
+  for (const Query *query : {&range, &lookup, &detector, &copy})
+  {
+    Counts counts;
+    std::vector<std::vector<int>> rowGroups;
+    for (auto &reader : readers)
+      rowGroups.push_back(Plan(*query, *reader, counts));
+    double seconds = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeat; ++r)
+      seconds = std::min(seconds, ReadSeconds(files, &rowGroups));
+
+    std::string predicate;
+    if (query->lookup)
+      predicate = "eventId=" + std::to_string(query->firstEvent);
+    else if (query->hasEvents)
+      predicate = std::to_string(query->firstEvent) + ":" + std::to_string(query->lastEvent);
+    else
+      predicate = query->detector + (query->hasCopy ? " copy " + std::to_string(query->copy) : "");
+    const std::string groups = std::to_string(counts.keptRowGroups) + "/" + std::to_string(counts.rowGroups);
+    const std::string pages =
+        counts.pages > 0 ? std::to_string(counts.keptPages) + "/" + std::to_string(counts.pages) : "-";
+    std::printf("%-18s %-24s %16s %8ld %7.1f%% %14s %10.2f %7.1fx\n", query->name.c_str(), predicate.c_str(),
+                groups.c_str(), counts.bloomSkipped, Percent(counts.keptRows, counts.rows), pages.c_str(),
+                seconds * 1e3, seconds > 0 ? fullSeconds / seconds : 0.);
+  }
+  return 0;
+}
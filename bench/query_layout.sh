@@ -0,0 +1,52 @@
+#!/bin/bash
+# Row-group and page skipping of eDep queries: default against sorted output.
+#
+#   bench/query_layout.sh [events] [threads] [workdir]
+#
+# Run from the directory exampleB1 is normally run from (the generator reads
+# work/generated_data_2p.csv), with octupole_batch and octupole_query_bench
+# in BUILD_DIR (default: ./build). The same fixed-seed macro runs with the
+# default layout, with --sort event --bloom and with --sort detector;
+# octupole_query_bench then reports the row groups, rows and pages each
+# query reads and its read time. QUERY_ARGS passes query options such as
+# --events or --detector.
+
+set -e
+
+EVENTS=${1:-100000}
+THREADS=${2:-4}
+WORKDIR=${3:-work/queryBench}
+BUILD_DIR=${BUILD_DIR:-build}
+
+mkdir -p "$WORKDIR"
+MACRO="$WORKDIR/bench.mac"
+cat > "$MACRO" <<MAC
+/run/initialize
+/random/setSeeds 12345 67890
+/run/printProgress 0
+/run/beamOn $EVENTS
+MAC
+
+run() {
+  local name=$1
+  shift
+  local out="$WORKDIR/$name"
+  rm -rf "$out"
+  mkdir -p "$out"
+  start=$(date +%s.%N)
+  "$BUILD_DIR/octupole_batch" -t "$THREADS" -o "$out" "$@" "$MACRO" > "$out/log.txt" 2>&1
+  end=$(date +%s.%N)
+  bytes=$(find "$out/eDep" -name '*.parquet' -printf '%s\n' | awk '{ s += $1 } END { print s }')
+  awk -v n="$name" -v s="$start" -v e="$end" -v b="$bytes" \
+    'BEGIN { printf "%-10s wall %.1f s, eDep %.1f MB\n", n, e - s, b / 1e6 }'
+}
+
+run default
+run event --sort event --bloom
+run detector --sort detector
+
+for name in default event detector; do
+  echo
+  echo "== $name"
+  "$BUILD_DIR/octupole_query_bench" "$WORKDIR/$name" $QUERY_ARGS
+done
@@ -0,0 +1,59 @@
+#!/bin/bash
+# Runs one /run/beamOn as N local shard processes and checks the dataset.
+#
+#   bench/run_shards.sh [events] [shards] [threads] [workdir]
+#
+# Each process runs octupole_batch --shard i/N on the same fixed-seed macro
+# and writes to <workdir>/dataset/shard<i>of<N>. With COMPARE=1 the same
+# events also run unsharded into <workdir>/single and compare_edep checks
+# that both datasets agree. Binaries are taken from BUILD_DIR (default:
+# ./build); run from the directory exampleB1 is normally run from.
+
+set -e
+
+EVENTS=${1:-10000}
+SHARDS=${2:-4}
+THREADS=${3:-1}
+WORKDIR=${4:-work/shards}
+BUILD_DIR=${BUILD_DIR:-build}
+
+mkdir -p "$WORKDIR"
+MACRO="$WORKDIR/shards.mac"
+cat > "$MACRO" <<EOF
+/run/initialize
+/random/setSeeds 12345 67890
+/run/printProgress 0
+/run/beamOn $EVENTS
+EOF
+
+rm -rf "$WORKDIR/dataset"
+mkdir -p "$WORKDIR/dataset"
+start=$(date +%s.%N)
+pids=""
+for ((i = 0; i < SHARDS; ++i)); do
+  "$BUILD_DIR/octupole_batch" -t "$THREADS" -o "$WORKDIR/dataset" --shard "$i/$SHARDS" "$MACRO" \
+    > "$WORKDIR/dataset/shard$i.log" 2>&1 &
+  pids="$pids $!"
+done
+failed=0
+for pid in $pids; do
+  wait "$pid" || failed=1
+done
+end=$(date +%s.%N)
+awk -v n="$EVENTS" -v k="$SHARDS" -v s="$start" -v e="$end" \
+  'BEGIN { printf "%d events in %d shards: %.1f s, %.1f events/s\n", n, k, e - s, n / (e - s) }'
+
+cat "$WORKDIR"/dataset/run=*/dataset.txt
+incomplete=$(grep -L "^complete 1" "$WORKDIR"/dataset/shard*of*/run=*/shard.txt || true)
+if [ "$failed" -ne 0 ] || [ -n "$incomplete" ]; then
+  echo "incomplete shards: $incomplete" >&2
+  exit 1
+fi
+
+if [ "${COMPARE:-0}" = 1 ]; then
+  rm -rf "$WORKDIR/single"
+  mkdir -p "$WORKDIR/single"
+  "$BUILD_DIR/octupole_batch" -t "$THREADS" -o "$WORKDIR/single" "$MACRO" > "$WORKDIR/single/log.txt" 2>&1
+  echo
+  "$BUILD_DIR/compare_edep" "$WORKDIR/single" "$WORKDIR/dataset"
+fi
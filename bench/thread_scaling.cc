@@ -0,0 +1,308 @@
+/// \file B1/bench/thread_scaling.cc
+/// \brief Thread-scaling benchmark driver for octupole_batch
+///
+/// Runs the same fixed-seed workload with each thread count in a separate
+/// octupole_batch process and writes one CSV line per configuration:
+///
+///   octupole_scaling [-e events] [-t 1,2,4,...] [-w workdir] [-r report.csv]
+///                    [--baseline old_report.csv] [--tolerance 0.1]
+///                    [--batch path/to/octupole_batch] [-- batch options]
+///
+/// Options after "--" are passed to octupole_batch, e.g. "-- -i input.csv -p lean".
+/// Event and step rates are computed from the run time in run_stats.txt (the
+/// event loop); wall time includes initialization. With a baseline report the
+/// event rate of every thread count found in both reports is compared and the
+/// driver exits with 2 if any dropped by more than the tolerance.
+///
+/// The baseline comparison also measures options against each other, e.g.
+/// worker pinning:
+///
+///   octupole_scaling -r floating.csv
+///   octupole_scaling -r pinned.csv --baseline floating.csv -- --pin scatter
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+#ifndef OCTUPOLE_BATCH_PATH
+#define OCTUPOLE_BATCH_PATH "octupole_batch"
+#endif
+
+namespace
+{
+
+  struct Result
+  {
+    int threads = 0;
+    long events = 0;
+    long steps = 0;
+    double wallTime = 0;
+    double runTime = 0;
+    long peakRssKB = 0;
+    uintmax_t outputBytes = 0;
+
+    double EventRate() const { return runTime > 0 ? events / runTime : 0; }
+    double StepRate() const { return runTime > 0 ? steps / runTime : 0; }
+  };
+
+  const char *kReportHeader = "threads,events,steps,wall_s,run_s,events_per_s,steps_per_s,peak_rss_kb,output_bytes";
+
+  std::vector<int> ParseThreadList(const std::string &list)
+  {
+    std::vector<int> threads;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+      if (std::atoi(item.c_str()) > 0)
+        threads.push_back(std::atoi(item.c_str()));
+    }
+    return threads;
+  }
+
+  void WriteMacro(const fs::path &macro, long events)
+  {
+    std::ofstream fout(macro);
+    fout << "/run/initialize\n"
+         << "/random/setSeeds 12345 67890\n"
+         << "/run/printProgress 0\n"
+         << "/run/beamOn " << events << "\n";
+  }
+
+  uintmax_t DirectorySize(const fs::path &dir)
+  {
+    uintmax_t bytes = 0;
+    for (const auto &entry : fs::recursive_directory_iterator(dir))
+    {
+      if (entry.is_regular_file() && entry.path().extension() == ".parquet")
+        bytes += entry.file_size();
+    }
+    return bytes;
+  }
+
+  /// Runs octupole_batch with its log in <outDir>/log.txt; false if it failed
+  bool RunBatch(const std::string &batch, const std::vector<std::string> &batchArgs, int threads,
+                const fs::path &macro, const fs::path &outDir, Result &result)
+  {
+    std::vector<std::string> args = {batch, "-t", std::to_string(threads), "-o", outDir.string()};
+    args.insert(args.end(), batchArgs.begin(), batchArgs.end());
+    args.push_back(macro.string());
+
+    // the child must not inherit unflushed output
+    std::fflush(nullptr);
+    std::cout.flush();
+    const auto start = std::chrono::steady_clock::now();
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+      std::perror("fork");
+      return false;
+    }
+    if (pid == 0)
+    {
+      const std::string log = (outDir / "log.txt").string();
+      if (!std::freopen(log.c_str(), "w", stdout) || !std::freopen(log.c_str(), "a", stderr))
+        _exit(127);
+      std::vector<char *> argv;
+      for (auto &arg : args)
+        argv.push_back(arg.data());
+      argv.push_back(nullptr);
+      execvp(argv[0], argv.data());
+      std::perror("execvp");
+      _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0)
+    {
+      std::perror("wait4");
+      return false;
+    }
+    result.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.peakRssKB = usage.ru_maxrss;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      std::cerr << "octupole_batch failed with " << threads << " threads, see " << (outDir / "log.txt")
+                << std::endl;
+      return false;
+    }
+
+    std::ifstream stats(outDir / "run_stats.txt");
+    std::string key;
+    while (stats >> key)
+    {
+      if (key == "events")
+        stats >> result.events;
+      else if (key == "steps")
+        stats >> result.steps;
+      else if (key == "runTime")
+        stats >> result.runTime;
+      else
+        stats.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    result.outputBytes = DirectorySize(outDir);
+    return true;
+  }
+
+  /// Event rates per thread count of a previous report
+  std::map<int, double> ReadBaseline(const std::string &fname)
+  {
+    std::map<int, double> rates;
+    std::ifstream fin(fname);
+    std::string line;
+    std::getline(fin, line);
+    if (line != kReportHeader)
+    {
+      std::cerr << "Unexpected baseline format: " << fname << std::endl;
+      return rates;
+    }
+    while (std::getline(fin, line))
+    {
+      std::istringstream iss(line);
+      std::vector<std::string> fields;
+      std::string field;
+      while (std::getline(iss, field, ','))
+        fields.push_back(field);
+      if (fields.size() >= 6)
+        rates[std::atoi(fields[0].c_str())] = std::atof(fields[5].c_str());
+    }
+    return rates;
+  }
+
+  void PrintUsage(const char *program)
+  {
+    std::cerr << "Usage: " << program
+              << " [-e events] [-t 1,2,4,...] [-w workdir] [-r report.csv]"
+                 " [--baseline report.csv] [--tolerance fraction] [--batch octupole_batch] [-- batch options]"
+              << std::endl;
+  }
+
+}
+
+int main(int argc, char **argv)
+{
+  long events = 20000;
+  std::vector<int> threadCounts = {1, 2, 4, 8, 16, 32, 64};
+  fs::path workDir = "work/threadScaling";
+  std::string report;
+  std::string baseline;
+  double tolerance = 0.1;
+  std::string batch = OCTUPOLE_BATCH_PATH;
+  std::vector<std::string> batchArgs;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(arg, "-e") && hasValue)
+      events = std::atol(argv[++i]);
+    else if (!std::strcmp(arg, "-t") && hasValue)
+      threadCounts = ParseThreadList(argv[++i]);
+    else if (!std::strcmp(arg, "-w") && hasValue)
+      workDir = argv[++i];
+    else if (!std::strcmp(arg, "-r") && hasValue)
+      report = argv[++i];
+    else if (!std::strcmp(arg, "--baseline") && hasValue)
+      baseline = argv[++i];
+    else if (!std::strcmp(arg, "--tolerance") && hasValue)
+      tolerance = std::atof(argv[++i]);
+    else if (!std::strcmp(arg, "--batch") && hasValue)
+      batch = argv[++i];
+    else if (!std::strcmp(arg, "--"))
+    {
+      batchArgs.assign(argv + i + 1, argv + argc);
+      break;
+    }
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (events <= 0 || threadCounts.empty())
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (report.empty())
+    report = (workDir / "report.csv").string();
+
+  fs::create_directories(workDir);
+  const fs::path macro = workDir / "scaling.mac";
+  WriteMacro(macro, events);
+
+  std::ofstream fout(report);
+  fout << kReportHeader << "\n";
+  std::printf("%8s %10s %10s %12s %14s %12s %14s\n", "threads", "wall[s]", "run[s]", "events/s", "steps/s",
+              "peakRSS[MB]", "output[MB]");
+
+  std::vector<Result> results;
+  bool failed = false;
+  for (int threads : threadCounts)
+  {
+    const fs::path outDir = workDir / ("t" + std::to_string(threads));
+    fs::remove_all(outDir);
+    fs::create_directories(outDir);
+
+    Result result;
+    result.threads = threads;
+    if (!RunBatch(batch, batchArgs, threads, macro, outDir, result))
+    {
+      failed = true;
+      continue;
+    }
+    results.push_back(result);
+    fout << result.threads << "," << result.events << "," << result.steps << "," << result.wallTime << ","
+         << result.runTime << "," << result.EventRate() << "," << result.StepRate() << "," << result.peakRssKB
+         << "," << result.outputBytes << "\n";
+    fout.flush();
+    std::printf("%8d %10.2f %10.2f %12.1f %14.1f %12.1f %14.2f\n", threads, result.wallTime, result.runTime,
+                result.EventRate(), result.StepRate(), result.peakRssKB / 1024., result.outputBytes / 1048576.);
+  }
+  std::cout << "Report written to " << report << std::endl;
+
+  if (!baseline.empty())
+  {
+    const auto baselineRates = ReadBaseline(baseline);
+    bool regression = false;
+    std::printf("\n%8s %14s %12s %10s\n", "threads", "baseline[ev/s]", "events/s", "change");
+    for (const auto &result : results)
+    {
+      const auto itr = baselineRates.find(result.threads);
+      if (itr == baselineRates.end() || itr->second <= 0)
+        continue;
+      const double ratio = result.EventRate() / itr->second;
+      std::printf("%8d %14.1f %12.1f %+9.1f%%\n", result.threads, itr->second, result.EventRate(),
+                  100. * (ratio - 1.));
+      if (ratio < 1. - tolerance)
+      {
+        std::printf("REGRESSION %d threads: %.1f events/s, baseline %.1f (%+.1f%%)\n", result.threads,
+                    result.EventRate(), itr->second, 100. * (ratio - 1.));
+        regression = true;
+      }
+    }
+    if (!regression)
+      std::cout << "No regression against " << baseline << " (tolerance " << 100. * tolerance << "%)"
+                << std::endl;
+    if (regression)
+      return 2;
+  }
+  return failed ? 1 : 0;
+}
@@ -27,32 +27,32 @@
 /// \file exampleB1.cc
 /// \brief Main program of the B1 example
 
-#include "DetectorConstruction.hh"
-#include "ActionInitialization.hh"
+#include "Application.hh"
+#include "AppOptions.hh"
 
-#include "G4RunManagerFactory.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
-#include "QBBC.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
 #include "Randomize.hh"
 
-#include "ExpConstants.hh"
-#include "ProtonGenerator.hh"
-
 using namespace B1;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc, char **argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  AppOptions options;
+  options.macroPath = "/home/sh22/simulation/octupole";
+  if (!options.Parse(argc, argv))
+    return 1;
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive *ui = nullptr;
-  if (argc == 1)
+  if (options.macro.empty())
   {
     ui = new G4UIExecutive(argc, argv);
   }
@@ -63,27 +63,14 @@ int main(int argc, char **argv)
   // G4int precision = 4;
   // G4SteppingVerbose::UseBestUnit(precision);
 
-  // Construct the default run manager
+  // Construct the run manager with detector, physics list and user actions
   //
-  auto *runManager =
-      G4RunManagerFactory::CreateRunManager(G4RunManagerType::MT, 1);
-
-  // #ifdef G4MULTITHREADED
-  // runManager->SetNumberOfThreads(1);
-  // #endif
-  //  Set mandatory initialization classes
-  //
-  //  Detector construction
-  runManager->SetUserInitialization(new DetectorConstruction());
-
-  // Physics list
-  G4VModularPhysicsList *physicsList = new QBBC;
-  // G4VModularPhysicsList *physicsList = new LHEP;
-  physicsList->SetVerboseLevel(1);
-  runManager->SetUserInitialization(physicsList);
-
-  // User action initialization
-  runManager->SetUserInitialization(new ActionInitialization("work/output"));
+  Application application(options);
+  if (!application.IsValid())
+  {
+    delete ui;
+    return 1;
+  }
 
   // Initialize visualization
   //
@@ -100,10 +87,7 @@ int main(int argc, char **argv)
   if (!ui)
   {
     // batch mode
-    UImanager->ApplyCommand("/control/macroPath /home/sh22/simulation/octupole");
-    G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command + fileName);
+    application.ExecuteMacro();
   }
   else
   {
@@ -114,12 +98,9 @@ int main(int argc, char **argv)
   }
 
   // Job termination
-  // Free the store: user actions, physics_list and detector_description are
-  // owned and deleted by the run manager, so they should not be deleted
-  // in the main() program !
+  // The run manager is deleted with the application, after the vis manager
 
   delete visManager;
-  delete runManager;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -32,6 +32,7 @@
 
 #include "globals.hh"
 #include "G4VUserActionInitialization.hh"
+#include "AppOptions.hh"
 
 /// Action initialization class.
 
@@ -43,13 +44,13 @@ namespace B1
   public:
     ActionInitialization() = default;
     ~ActionInitialization() override = default;
-    ActionInitialization(const std::string &file_prefix) : file_prefix_(file_prefix) {}
+    ActionInitialization(const AppOptions &options) : options_(options) {}
 
     void BuildForMaster() const override;
     void Build() const override;
 
   private:
-    const std::string file_prefix_;
+    const AppOptions options_;
   };
 
 }
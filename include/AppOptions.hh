@@ -0,0 +1,87 @@
+/// \file B1/include/AppOptions.hh
+/// \brief Definition of the B1::AppOptions class
+
+#ifndef B1AppOptions_h
+#define B1AppOptions_h 1
+
+#include "globals.hh"
+
+/// Command line options of the application.
+///
+///   exampleB1 [options] [macro]
+///   octupole_batch [options] macro
+///
+/// Without a macro exampleB1 starts the interactive session. See PrintUsage()
+/// for the options.
+
+namespace B1
+{
+
+  class AppOptions
+  {
+  public:
+    static constexpr G4int kDefaultCheckpointInterval = 10000;
+
+    /// Returns false (after printing the usage) on invalid arguments
+    bool Parse(int argc, char **argv);
+    void PrintUsage(const char *program) const;
+
+    G4String macro;
+    G4String macroPath;
+    G4String physicsList;
+    G4String outputPrefix = "work/output";
+    G4String inputFile = "work/generated_data_2p.csv";
+    /// Worker threads, 0 leaves the choice to the macro (/run/numberOfThreads)
+    G4int nThreads = 0;
+    /// Run manager: "mt" (fixed worker threads, as before) or "tasking" (work stealing)
+    G4String runManager = "mt";
+    /// Events per batch, 0 sizes the batches from the event cost, see EventBatching
+    G4int eventBatch = 0;
+    /// Live Arrow IPC stream, fifo:<path> or unix:<path>, empty disables it, see IpcStreamSink
+    G4String stream;
+    G4String streamPolicy = "drop";
+    G4int streamQueue = 64;
+    G4int streamBatch = 1000;
+    /// Fraction of the events whose truth tracks are recorded, and whether
+    /// with secondaries, see TruthRecorder
+    G4double truthFraction = 0.;
+    G4bool truthSecondaries = false;
+    /// Relative uncertainty at which a run stops and its target quantity,
+    /// 0 runs all events, see PrecisionTarget
+    G4double precision = 0.;
+    G4String precisionTarget = "coincidence";
+    /// Worker pinning layout, empty or none leaves threads floating, see ThreadPlacement
+    G4String pin;
+    /// Step census by volume, particle and creator process, see StepCensus
+    G4bool stepCensus = false;
+    /// Strip clustering and dE-E reconstruction, and whether the raw hits are
+    /// dropped (--reco-only), see Reconstruction
+    G4bool reco = false;
+    G4bool recoOnly = false;
+    /// Sort order of the output rows (none, event or detector), rows per
+    /// row group and bloom filters on eventId, see OutputLayout
+    G4String sortOrder;
+    G4int rowGroupRows = 0;
+    G4bool bloomFilters = false;
+    /// Single-step transport of protons through the target, see TargetFastModel
+    G4bool fastTarget = false;
+    /// Telemetry file or unix:<socket>, empty disables it, see Telemetry
+    G4String telemetry;
+    G4double telemetryInterval = 10.;
+    /// Events per worker between checkpoints, 0 disables them, see CheckpointManager
+    G4int checkpointInterval = 0;
+    /// Continue from the checkpoint of the output prefix
+    G4bool resume = false;
+    /// Shard index and count (--shard i/N), count 0 runs unsharded; with
+    /// sharding outputPrefix is the shard directory inside datasetPrefix,
+    /// see Sharding
+    G4int shardIndex = 0;
+    G4int shardCount = 0;
+    G4String datasetPrefix;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
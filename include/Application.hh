@@ -0,0 +1,47 @@
+/// \file B1/include/Application.hh
+/// \brief Definition of the B1::Application class
+
+#ifndef B1Application_h
+#define B1Application_h 1
+
+#include "AppOptions.hh"
+#include "globals.hh"
+
+class G4RunManager;
+
+/// Application setup shared by exampleB1 and octupole_batch.
+///
+/// Creates the run manager with the detector construction, the selected
+/// physics list, the physics table cache and the user actions, without any
+/// UI or visualization driver. The run manager and the cache are deleted
+/// with the application.
+
+namespace B1
+{
+
+  class PhysicsTableCache;
+
+  class Application
+  {
+  public:
+    Application(const AppOptions &options);
+    ~Application();
+
+    /// False if the setup failed, e.g. for an unknown physics list
+    bool IsValid() const { return run_manager_ != nullptr; }
+    G4RunManager *GetRunManager() const { return run_manager_; }
+
+    /// Sets the macro search path and executes the macro of the options
+    void ExecuteMacro() const;
+
+  private:
+    const AppOptions options_;
+    G4RunManager *run_manager_ = nullptr;
+    PhysicsTableCache *physics_table_cache_ = nullptr;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
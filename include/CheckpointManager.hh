@@ -0,0 +1,112 @@
+/// \file B1/include/CheckpointManager.hh
+/// \brief Definition of the B1::CheckpointManager class
+
+#ifndef B1CheckpointManager_h
+#define B1CheckpointManager_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Checkpoints of a long run and resume after a failure.
+///
+/// With --checkpoint <n> every worker flushes its output to a new part file
+/// in the run partition of each table, see RunMetadata (eDep/run=<R>/
+/// worker<N>_part<K>.parquet, evtInfo/run=<R>/worker_<N>_part<K>.parquet and
+/// with --reco and --truth reco/ and truth/run=<R>/worker_<N>_part<K>.parquet)
+/// after every n of its events and commits the part count, its generator
+/// cursor and the ranges of completed event IDs to the manifest of the run,
+/// <prefix>/checkpoint/run<R>/manifest.txt. The manifest is replaced
+/// atomically, so it only ever references complete part files.
+///
+/// With --resume the master reloads the manifest of each run at its
+/// beginning and deletes part files the manifest does not know; the events
+/// get the same seeds as in the first attempt, see EventSeeder. Workers restore their part count only: the
+/// seed and the input row of an event follow from its ID, the cursor is
+/// informational. The generator skips the completed events: they are aborted
+/// without a primary vertex and not recorded. The resumed job must run the
+/// same macro: runs the manifest marks complete are skipped entirely, the
+/// interrupted run continues, and runs without a manifest start from scratch.
+
+namespace B1
+{
+
+  class CheckpointManager
+  {
+  public:
+    /// Inclusive range of global event IDs
+    using EventRange = std::pair<int64_t, int64_t>;
+
+    struct WorkerState
+    {
+      G4int parts = 0;
+      uint64_t cursor = 0;
+      std::vector<EventRange> completed;
+    };
+
+    static CheckpointManager &Instance();
+
+    /// interval: events per worker between checkpoints, 0 disables checkpoints
+    void Configure(G4int interval, G4bool resume);
+    G4bool IsEnabled() const { return interval_ > 0; }
+    G4bool IsResuming() const { return resuming_; }
+    G4int GetInterval() const { return interval_; }
+
+    /// Master, beginning of the run: writes a new manifest, or loads the one
+    /// of the run when resuming. Returns false if the checkpoint does not
+    /// match the run.
+    G4bool BeginRun(const std::string &prefix, G4int runId, int64_t eventsToProcess);
+    /// Master, end of the run: marks the manifest complete
+    void EndRun();
+
+    /// True if the event was completed by a previous attempt. Read-only
+    /// after BeginRun(), safe to call from the workers.
+    G4bool IsCompleted(int64_t eventId) const;
+
+    /// State committed by a worker in a previous attempt
+    WorkerState GetWorkerState(G4int workerId) const;
+    /// Records a checkpoint of a worker and rewrites the manifest
+    void Commit(G4int workerId, G4int parts, uint64_t cursor, const std::vector<EventRange> &completed);
+
+    /// Output part files of a worker
+    static std::string EDepPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part);
+    static std::string EvtInfoPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part);
+    static std::string RecoPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part);
+    static std::string TruthPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part);
+
+    /// Adds an event ID to a sorted list of disjoint ranges, extending the
+    /// last range if the ID follows it
+    static void AddToRanges(std::vector<EventRange> &ranges, int64_t eventId);
+    /// Sorts the ranges and merges the overlapping and adjacent ones
+    static void MergeRanges(std::vector<EventRange> &ranges);
+
+  private:
+    CheckpointManager() = default;
+
+    G4bool LoadManifest();
+    void WriteManifest() const;
+    void DeleteOrphanParts() const;
+
+    G4int interval_ = 0;
+    G4bool resuming_ = false;
+    std::string directory_;
+    std::string prefix_;
+    G4int run_id_ = 0;
+    int64_t events_to_process_ = 0;
+    G4bool complete_ = false;
+    std::map<G4int, WorkerState> workers_;
+    /// All completed ranges of the previous attempts, sorted
+    std::vector<EventRange> skip_;
+    mutable std::mutex mutex_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
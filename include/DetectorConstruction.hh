@@ -33,26 +33,68 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
 
+#include <map>
+
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4Region;
+class G4UserLimits;
 
 /// Detector construction class to define materials and geometry.
+///
+/// The target, the front Si, the Si strips and the CsI crystals are placed in
+/// their own regions so that production cuts and step limits can be chosen
+/// per detector. The world region is the default region of the world volume
+/// (air and the detector mother volume), its cut is the default cut of the
+/// physics list. Defaults are in ExpConstants.hh, the settings can be changed
+/// from macros, see DetectorMessenger. Only regions with a step limit get
+/// user limits, and the step limiter process is registered with the first
+/// limit, which must come before /run/initialize.
 
 namespace B1
 {
 
+class DetectorMessenger;
+
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
   public:
-    DetectorConstruction() = default;
-    ~DetectorConstruction() override = default;
+    DetectorConstruction();
+    ~DetectorConstruction() override;
 
     G4VPhysicalVolume* Construct() override;
+    /// Attaches the target fast model to the target region (--fast-target)
+    void ConstructSDandField() override;
 
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
 
+    /// Region names accepted by the setters, as a candidate list
+    static G4String RegionNames();
+    void SetRegionCut(const G4String &name, G4double cut);
+    void SetRegionMaxStep(const G4String &name, G4double maxStep);
+    void PrintRegions() const;
+
   protected:
     G4LogicalVolume* fScoringVolume = nullptr;
+
+  private:
+    struct RegionSettings
+    {
+      G4String regionName;
+      G4double cut;
+      G4double maxStep = 0.;
+      G4Region *region = nullptr;
+      G4UserLimits *limits = nullptr;
+    };
+
+    void CreateRegion(const G4String &name, G4LogicalVolume *rootVolume);
+    /// Registers G4StepLimiterPhysics with the first step limit; false after
+    /// /run/initialize if it is not registered yet
+    static G4bool EnableStepLimiter();
+    void ApplyRegionSettings(RegionSettings &settings);
+
+    std::map<G4String, RegionSettings> regions_;
+    DetectorMessenger *messenger_;
 };
 
 }
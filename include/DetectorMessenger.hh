@@ -0,0 +1,50 @@
+/// \file B1/include/DetectorMessenger.hh
+/// \brief Definition of the B1::DetectorMessenger class
+
+#ifndef B1DetectorMessenger_h
+#define B1DetectorMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+
+/// Messenger of the detector construction.
+///
+///   /octupole/region/setCut <region> <value> <unit>
+///   /octupole/region/setMaxStep <region> <value> <unit>   (0 removes the limit)
+///   /octupole/region/print
+///
+/// with <region> one of target, frontSi, strips, csi, world.
+
+namespace B1
+{
+
+  class DetectorConstruction;
+
+  class DetectorMessenger : public G4UImessenger
+  {
+  public:
+    DetectorMessenger(DetectorConstruction *detector);
+    ~DetectorMessenger() override;
+
+    void SetNewValue(G4UIcommand *command, G4String newValue) override;
+
+  private:
+    G4UIcommand *CreateRegionCommand(const G4String &path, const G4String &guidance);
+
+    DetectorConstruction *detector_;
+    G4UIdirectory *directory_;
+    G4UIdirectory *region_directory_;
+    G4UIcommand *set_cut_cmd_;
+    G4UIcommand *set_max_step_cmd_;
+    G4UIcmdWithoutParameter *print_cmd_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
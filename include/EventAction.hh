@@ -30,11 +30,13 @@
 #ifndef B1EventAction_h
 #define B1EventAction_h 1
 
+#include <chrono>
+#include <map>
 #include <vector>
-#include <memory>
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "ExpConstants.hh"
+#include "Reconstruction.hh"
 
 /// Event action class
 ///
@@ -47,7 +49,7 @@ namespace B1
   class EventAction : public G4UserEventAction
   {
   public:
-    EventAction(std::shared_ptr<RunAction> runAction);
+    EventAction(RunAction *runAction);
     ~EventAction() override = default;
 
     void BeginOfEventAction(const G4Event *event) override;
@@ -56,12 +58,18 @@ namespace B1
     void AddSiEdep(const G4double &eDep, G4int copyNum);
     void AddCsIEdep(const G4double &eDep, G4int copyNum);
     void AddFrontEdep(const G4double &eDep);
+    void AddStep() { ++nSteps_; }
 
   private:
     double frontSi_;
+    G4long nSteps_ = 0;
     std::map<int, double> SiMap_;
     std::map<int, double> CsIMap_;
-    std::shared_ptr<RunAction> runAction_;
+    // reused by every event, see Reconstruction
+    std::vector<RecoHit> recoHits_;
+    // per-event wall time, see RunAction::AddEventTime
+    std::chrono::steady_clock::time_point start_;
+    RunAction *runAction_;
   };
 
 }
@@ -0,0 +1,55 @@
+/// \file B1/include/EventBatching.hh
+/// \brief Definition of the B1::EventBatching class
+
+#ifndef B1EventBatching_h
+#define B1EventBatching_h 1
+
+#include "globals.hh"
+
+/// Event batch size of the MT and tasking run managers.
+///
+/// Workers take events from the master in batches of the event modulo; the
+/// tasking run manager additionally splits the run into tasks of one batch,
+/// which idle threads steal from the shared queue. Large batches leave some
+/// workers with a long tail when event costs vary (protons stopping in the
+/// front Si vs. showering in the CsI), small ones cost a master round trip
+/// or a task each.
+///
+/// With --event-batch n every run uses batches of n events. Otherwise the
+/// batch is sized from the mean event cost of the previous run so that a
+/// batch takes about kTargetBatchSeconds, with at least kMinBatchesPerThread
+/// batches per thread; the first run uses the Geant4 defaults. Since every
+/// event is seeded from its global ID (EventSeeder), the batch size does
+/// not change the results.
+
+namespace B1
+{
+
+  class EventBatching
+  {
+  public:
+    static constexpr G4double kTargetBatchSeconds = 0.02;
+    static constexpr G4int kMinBatchesPerThread = 8;
+
+    /// Fixed number of events per batch, 0 sizes the batches adaptively
+    static void Configure(G4int fixedBatch) { fixed_batch_ = fixedBatch; }
+
+    /// Master, beginning of the run: sets the event modulo and the tasks
+    static void BeginRun(G4int nEvents);
+    /// Master, end of the run: wall time summed over the events of the run
+    static void EndRun(G4int nEvents, G4double eventSeconds);
+
+    /// Events per batch for a mean event cost in seconds
+    static G4int BatchSize(G4int nEvents, G4int nThreads, G4double eventCost);
+
+  private:
+    static G4int fixed_batch_;
+    // mean wall time of an event in the previous run, 0 if unknown
+    static G4double event_cost_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
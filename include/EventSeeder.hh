@@ -0,0 +1,65 @@
+/// \file B1/include/EventSeeder.hh
+/// \brief Definition of the B1::EventSeeder class
+
+#ifndef B1EventSeeder_h
+#define B1EventSeeder_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+
+class G4Event;
+
+/// Per-event seeding from the global event ID.
+///
+/// At the beginning of each run the master derives a base seed from a job
+/// seed and the run ID. The job seed is drawn from the master engine at the
+/// first run, and again when the engine state differs from the one the
+/// previous run left, i.e. after /random/setSeeds or /random/resetEngineFrom,
+/// so the seeds keep selecting the sequence; the engine state the events of
+/// a run leave behind is never drawn from. Run R of a
+/// shard thus gets the same seeds whatever the previous runs simulated, and
+/// a resumed job gets the seeds of the first attempt.
+///
+/// Before the primaries of an event are generated, the worker engine is
+/// reseeded from a hash of the base seed and the global event ID, and the
+/// generator reads the input row of that ID. An event is therefore simulated
+/// identically whichever thread processes it and however many threads the
+/// job has.
+
+namespace B1
+{
+
+  class EventSeeder
+  {
+  public:
+    /// Master, beginning of the run
+    static void BeginRun(G4int runId);
+    /// Master, end of the run: remembers the engine state to detect a reseed
+    static void EndRun();
+
+    /// Global ID of an event of this process
+    static int64_t GlobalEventId(const G4Event *event);
+
+    /// Reseeds the engine of the calling thread for an event
+    static void SeedEvent(int64_t globalEventId);
+    /// Seed of the run the event seeds derive from
+    static uint64_t GetBaseSeed() { return base_seed_; }
+    /// Master engine state the job seed was drawn from (CLHEP put format)
+    static const std::string &GetSeedStatus() { return seed_status_; }
+
+  private:
+    static uint64_t base_seed_;
+    static uint64_t job_seed_;
+    static G4bool job_seed_drawn_;
+    static std::string seed_status_;
+    /// Engine state at the end of the previous run
+    static std::string end_status_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
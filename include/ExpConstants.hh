@@ -26,6 +26,17 @@ namespace B1
     // static G4RotationMatrix kRotation(0, -45 * deg, 0);
     // static G4ThreeVector kPosition(0, (1) * cm, (9 - 4.14) * cm);
     const bool kLimitTo2Pi = true;
+    // Reconstruction thresholds, see Reconstruction
+    const G4double kSiStripThreshold = 0.05 * MeV;
+    const G4double kFrontSiThreshold = 0.05 * MeV;
+    const G4double kCsIThreshold = 0.5 * MeV;
+    // Default production cuts per region, see DetectorConstruction.
+    // Fine cuts only where the deposits are resolved (thin Si layers).
+    const G4double kWorldCut = 10. * mm;
+    const G4double kTargetCut = 1. * mm;
+    const G4double kFrontSiCut = 0.03 * mm;
+    const G4double kSiStripCut = 0.1 * mm;
+    const G4double kCsICut = 1. * mm;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+/// \file B1/include/IpcStreamSink.hh
+/// \brief Definition of the B1::IpcStreamSink class
+
+#ifndef B1IpcStreamSink_h
+#define B1IpcStreamSink_h 1
+
+#include "globals.hh"
+
+#include <arrow/api.h>
+
+#include <memory>
+#include <string>
+
+/// Live Arrow IPC stream output (--stream).
+///
+/// Next to the Parquet files, the record batches the workers cut from their
+/// builders every --stream-batch events are published as they fill, one
+/// Arrow IPC stream per table:
+///
+///   fifo:<path>  named pipes <path>.eDep and <path>.evtInfo, created if missing
+///   unix:<path>  stream sockets <path>.eDep and <path>.evtInfo the consumer listens on
+///
+/// The batches are shared with the Parquet output, not copied, and written
+/// straight from their buffers; every new connection starts with the schema,
+/// so a consumer reads them with arrow::ipc::RecordBatchStreamReader, or
+/// records the stream to a file and memory-maps it.
+///
+/// A writer thread per table sends the queued batches, so the workers never
+/// wait for a consumer unless asked to. When the queue of a table is full
+/// (--stream-queue batches) the policy (--stream-policy) decides:
+///
+///   drop    the new batch is dropped (default)
+///   oldest  the oldest queued batch is dropped
+///   block   the worker waits until the consumer catches up
+///
+/// Without a connected consumer batches are dropped whatever the policy,
+/// and the writer retries to connect every second. The batches sent and
+/// dropped are printed at the end of each run.
+
+namespace B1
+{
+
+  class IpcStreamSink
+  {
+  public:
+    enum class Table
+    {
+      EDep,
+      EvtInfo
+    };
+
+    /// Starts the writer threads; false for an invalid destination or policy
+    static G4bool Configure(const std::string &destination, const std::string &policy, G4int queueBatches,
+                            G4int batchEvents, std::shared_ptr<arrow::Schema> eDepSchema,
+                            std::shared_ptr<arrow::Schema> evtInfoSchema);
+    static G4bool IsEnabled() { return enabled_; }
+    /// Events per record batch
+    static G4int GetBatchEvents() { return batch_events_; }
+
+    /// Queues a batch of a table, from any worker
+    static void Publish(Table table, std::shared_ptr<arrow::RecordBatch> batch);
+
+    /// Prints and restarts the counters of the run, from the master
+    static void PrintRunSummary(std::ostream &os);
+    /// Sends the queued batches and stops the writer threads
+    static void Shutdown();
+
+  private:
+    static G4bool enabled_;
+    static G4int batch_events_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
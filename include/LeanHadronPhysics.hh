@@ -0,0 +1,33 @@
+/// \file B1/include/LeanHadronPhysics.hh
+/// \brief Definition of the B1::LeanHadronPhysics class
+
+#ifndef B1LeanHadronPhysics_h
+#define B1LeanHadronPhysics_h 1
+
+#include "G4VPhysicsConstructor.hh"
+#include "globals.hh"
+
+/// Minimal hadronic physics constructor.
+///
+/// Elastic and inelastic scattering of protons and neutrons with the binary
+/// cascade, plus neutron capture. Other hadrons and light ions produced in
+/// the cascade are transported with EM physics only.
+
+namespace B1
+{
+
+  class LeanHadronPhysics : public G4VPhysicsConstructor
+  {
+  public:
+    LeanHadronPhysics(G4int verbose = 1);
+    ~LeanHadronPhysics() override = default;
+
+    void ConstructParticle() override;
+    void ConstructProcess() override;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,31 @@
+/// \file B1/include/LeanPhysicsList.hh
+/// \brief Definition of the B1::LeanPhysicsList class
+
+#ifndef B1LeanPhysicsList_h
+#define B1LeanPhysicsList_h 1
+
+#include "G4VModularPhysicsList.hh"
+#include "globals.hh"
+
+/// Lean physics list for 10-300 MeV protons in Si and CsI.
+///
+/// Standard EM option 3 with tables limited to the energy range of the
+/// experiment and no atomic de-excitation, decays, and a minimal hadronic
+/// set (LeanHadronPhysics) for protons and neutrons only. Selected with
+/// "-p lean" or OCTUPOLE_PHYSICS_LIST=lean, see PhysicsListSelector.hh.
+
+namespace B1
+{
+
+  class LeanPhysicsList : public G4VModularPhysicsList
+  {
+  public:
+    LeanPhysicsList();
+    ~LeanPhysicsList() override = default;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
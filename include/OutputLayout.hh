@@ -0,0 +1,71 @@
+/// \file B1/include/OutputLayout.hh
+/// \brief Definition of the B1::OutputLayout class
+
+#ifndef B1OutputLayout_h
+#define B1OutputLayout_h 1
+
+#include "globals.hh"
+
+#include <arrow/api.h>
+#include <parquet/properties.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Query-friendly layout of the Parquet output (--sort).
+///
+/// By default the tables are written in the order the worker filled them,
+/// with the default writer properties. With --sort event the rows of every
+/// file are sorted by eventId, then by detector (detName, copyId, or csiId
+/// in reco) and by track or cluster; with --sort detector by detector, then
+/// eventId. The sorted table is written in row groups of --row-group rows
+/// with min/max statistics, the page index (column and offset indexes) and
+/// its sort order in the metadata, so a reader selecting an eventId range,
+/// a detector or a copyId skips the row groups and pages whose statistics
+/// exclude it. --bloom adds bloom filters on eventId for lookups of single
+/// events, if the Parquet library writes them (OCTUPOLE_PARQUET_BLOOM_FILTER,
+/// see CMakeLists.txt); detName and copyId have too few values to profit.
+///
+/// The worker sorts each table right before writing it, at the end of its
+/// run or at a checkpoint. bench/query_layout.sh measures the skipping.
+
+namespace B1
+{
+
+  class OutputLayout
+  {
+  public:
+    enum class Order
+    {
+      None,
+      Event,
+      Detector
+    };
+
+    static constexpr int64_t kDefaultRowGroupRows = 65536;
+    static constexpr G4double kBloomFilterFpp = 0.01;
+
+    /// False for an unknown order; "none" or empty keeps the default layout
+    static G4bool Configure(const std::string &order, int64_t rowGroupRows, G4bool bloomFilters);
+    static Order GetOrder() { return order_; }
+
+    /// Sort keys of the order among the columns of the schema
+    static std::vector<std::string> SortKeys(const arrow::Schema &schema);
+    static std::shared_ptr<parquet::WriterProperties> WriterProperties(const arrow::Schema &schema);
+
+    /// Writes the table to a Parquet file, sorted with the configured order
+    static void Write(std::shared_ptr<arrow::Table> table, const std::string &file, arrow::MemoryPool *pool);
+
+  private:
+    static Order order_;
+    static int64_t row_group_rows_;
+    static G4bool bloom_filters_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
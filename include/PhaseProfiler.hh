@@ -0,0 +1,151 @@
+/// \file B1/include/PhaseProfiler.hh
+/// \brief Definition of the B1::PhaseProfiler class
+
+#ifndef B1PhaseProfiler_h
+#define B1PhaseProfiler_h 1
+
+#include "globals.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/// Per-thread phase profiler.
+///
+/// Accumulates ticks (TSC cycles on x86, steady clock nanoseconds elsewhere)
+/// and call counts per phase of the event processing in thread-local
+/// counters. Each worker merges its counters into the master totals at the
+/// end of its run; the master prints them next to the run summary and writes
+/// them to <prefix>/run_profile.txt.
+///
+/// The instrumentation macros expand to nothing unless the code is compiled
+/// with OCTUPOLE_PROFILING=1 (CMake option OCTUPOLE_PROFILING).
+
+namespace B1
+{
+
+  enum class Phase
+  {
+    Event,             ///< BeginOfEventAction to EndOfEventAction, transport included
+    Stepping,          ///< UserSteppingAction
+    EventAccumulation, ///< EndOfEventAction, includes the Arrow appends of the event
+    ArrowAppendHit,    ///< RunAction::AddEdep
+    ArrowAppendEvent,  ///< RunAction::AddEventInfo
+    ParquetWrite,      ///< RunAction::WriteTables
+    Reconstruction,    ///< Reconstruction::Reconstruct and the appends of its hits
+    Count
+  };
+
+  class PhaseProfiler
+  {
+  public:
+#if OCTUPOLE_PROFILING
+    static constexpr bool kEnabled = true;
+#else
+    static constexpr bool kEnabled = false;
+#endif
+    static constexpr int kNPhases = static_cast<int>(Phase::Count);
+
+    /// Profiler of the calling thread
+    static PhaseProfiler &Instance();
+
+    static uint64_t ReadTicks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+#endif
+    }
+
+    void Add(Phase phase, uint64_t ticks)
+    {
+      ticks_[static_cast<int>(phase)] += ticks;
+      ++calls_[static_cast<int>(phase)];
+    }
+    void Begin(Phase phase) { start_[static_cast<int>(phase)] = ReadTicks(); }
+    void End(Phase phase) { Add(phase, ReadTicks() - start_[static_cast<int>(phase)]); }
+
+    /// Adds the counters of the calling thread to the master totals and
+    /// resets them
+    void MergeToMaster();
+
+    /// Clears the master totals and starts the tick calibration, at the
+    /// beginning of the global run
+    static void ResetMaster();
+    /// Prints the master totals
+    static void PrintMaster(std::ostream &os);
+    /// Writes the master totals as a table, one line per phase
+    static void WriteMaster(const std::string &fname);
+
+  private:
+    std::array<uint64_t, kNPhases> ticks_{};
+    std::array<uint64_t, kNPhases> calls_{};
+    std::array<uint64_t, kNPhases> start_{};
+  };
+
+  /// Conversion of the ticks to seconds, calibrated against the steady clock
+  /// over the time since Start()
+  class TickCalibration
+  {
+  public:
+    void Start()
+    {
+      time_ = std::chrono::steady_clock::now();
+      ticks_ = PhaseProfiler::ReadTicks();
+    }
+    double TicksPerSecond() const
+    {
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_).count();
+      const uint64_t ticks = PhaseProfiler::ReadTicks() - ticks_;
+      return seconds > 0 && ticks > 0 ? ticks / seconds : 1e9;
+    }
+
+  private:
+    std::chrono::steady_clock::time_point time_;
+    uint64_t ticks_ = 0;
+  };
+
+  /// Adds the time from construction to destruction to a phase
+  class ScopedPhase
+  {
+  public:
+    ScopedPhase(Phase phase)
+        : profiler_(PhaseProfiler::Instance()), phase_(phase), start_(PhaseProfiler::ReadTicks())
+    {
+    }
+    ~ScopedPhase() { profiler_.Add(phase_, PhaseProfiler::ReadTicks() - start_); }
+
+  private:
+    PhaseProfiler &profiler_;
+    const Phase phase_;
+    const uint64_t start_;
+  };
+
+}
+
+#define OCTUPOLE_PROFILE_CONCAT_(a, b) a##b
+#define OCTUPOLE_PROFILE_CONCAT(a, b) OCTUPOLE_PROFILE_CONCAT_(a, b)
+
+#if OCTUPOLE_PROFILING
+#define OCTUPOLE_PROFILE_SCOPE(phase) \
+  B1::ScopedPhase OCTUPOLE_PROFILE_CONCAT(octupoleScopedPhase, __LINE__)(phase)
+#define OCTUPOLE_PROFILE_BEGIN(phase) B1::PhaseProfiler::Instance().Begin(phase)
+#define OCTUPOLE_PROFILE_END(phase) B1::PhaseProfiler::Instance().End(phase)
+#else
+#define OCTUPOLE_PROFILE_SCOPE(phase)
+#define OCTUPOLE_PROFILE_BEGIN(phase)
+#define OCTUPOLE_PROFILE_END(phase)
+#endif
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
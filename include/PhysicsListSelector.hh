@@ -0,0 +1,29 @@
+/// \file B1/include/PhysicsListSelector.hh
+/// \brief Runtime selection of the physics list
+
+#ifndef B1PhysicsListSelector_h
+#define B1PhysicsListSelector_h 1
+
+#include "globals.hh"
+
+class G4VModularPhysicsList;
+
+namespace B1
+{
+
+  /// Physics list name to use: the requested one (command line) if not empty,
+  /// otherwise OCTUPOLE_PHYSICS_LIST, otherwise "QBBC".
+  G4String SelectPhysicsListName(const G4String &requested);
+
+  /// "lean" creates the application LeanPhysicsList, any other name is looked
+  /// up as a Geant4 reference physics list. With --fast-target both get the
+  /// fast simulation of protons used by TargetFastModel; the step limiter is
+  /// added by DetectorConstruction with the first region step limit. Returns
+  /// nullptr for unknown names.
+  G4VModularPhysicsList *CreatePhysicsList(const G4String &name);
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
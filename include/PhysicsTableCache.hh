@@ -0,0 +1,62 @@
+/// \file B1/include/PhysicsTableCache.hh
+/// \brief Definition of the B1::PhysicsTableCache class
+
+#ifndef B1PhysicsTableCache_h
+#define B1PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <string>
+
+class G4VUserPhysicsList;
+
+/// Physics table cache.
+///
+/// Watches the master state transitions around the first run initialization.
+/// Right before the physics tables are built, a key is computed from the
+/// Geant4 version, the physics list, the material table and the production
+/// cuts of every region. If a cache entry with the same key exists, the
+/// tables are retrieved from it, otherwise they are built as usual and stored
+/// once the run initialization has finished. The time spent to get the tables
+/// ready is logged so that a cold start can be compared with a warm one.
+/// An empty cache directory disables the cache but keeps the timing.
+
+namespace B1
+{
+
+  class PhysicsTableCache : public G4VStateDependent
+  {
+  public:
+    PhysicsTableCache(G4VUserPhysicsList *physicsList, const std::string &cacheDir);
+    ~PhysicsTableCache() override = default;
+
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+    /// Cache directory from OCTUPOLE_PHYSICS_CACHE, "work/physicsCache" if unset.
+    /// "none" or an empty value disables the cache.
+    static std::string DefaultDirectory();
+
+  private:
+    void PrepareTables();
+    void TablesReady();
+    std::string ComputeKey() const;
+    bool StoreTables(const std::string &key) const;
+
+    G4VUserPhysicsList *physicsList_;
+    const std::string cache_dir_;
+    std::string entry_dir_;
+    std::string key_;
+    bool prepared_ = false;
+    bool reported_ = false;
+    bool retrieved_ = false;
+    std::chrono::steady_clock::time_point launch_time_;
+    std::chrono::steady_clock::time_point build_start_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,68 @@
+/// \file B1/include/PrecisionTarget.hh
+/// \brief Definition of the B1::PrecisionTarget class
+
+#ifndef B1PrecisionTarget_h
+#define B1PrecisionTarget_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <ostream>
+#include <string>
+
+/// Adaptive run termination on a statistical precision target (--precision).
+///
+/// The target quantity is the fraction of events passing a selection
+/// (--target):
+///
+///   coincidence            a strip above kSiStripThreshold and a CsI
+///                          crystal above kCsIThreshold (default)
+///   strips:<a>-<b>         a strip a..b above kSiStripThreshold
+///   dee:<dE0>-<dE1>,<E0>-<E1>
+///                          front Si dE and summed CsI E inside the region, MeV
+///
+/// Each worker counts its events and selected events and adds them to the
+/// merged estimator of the master every kMergeEvents events. Whenever the
+/// merged relative uncertainty of the fraction, sqrt((1 - p) / selected),
+/// is at or below the requested precision (after at least kMinEvents
+/// events and kMinSelected selected), the master run manager is aborted
+/// softly: no further events are handed out and the events in flight
+/// complete, so the output stays consistent. /run/beamOn then only sets
+/// the largest number of events of the run.
+
+namespace B1
+{
+
+  class PrecisionTarget
+  {
+  public:
+    static constexpr G4int kMergeEvents = 100;
+    static constexpr G4long kMinEvents = 1000;
+    static constexpr G4long kMinSelected = 10;
+
+    /// False for an invalid target; a precision of 0 disables it
+    static G4bool Configure(const std::string &target, G4double precision);
+    static G4bool IsEnabled() { return enabled_; }
+
+    /// Whether the deposits of an event pass the selection of the target
+    static G4bool Selects(const std::map<int, double> &strips, G4double eFront, const std::map<int, double> &csi);
+
+    /// Records an event of the calling worker; merges every kMergeEvents
+    /// events and aborts the run once the precision is reached
+    static void AddEvent(G4bool selected);
+    /// Merges the remaining events of the calling worker, at its end of run
+    static void MergeToMaster();
+
+    /// Clears the merged estimator, from the master BeginOfRunAction
+    static void ResetMaster();
+    static void PrintMaster(std::ostream &os);
+
+  private:
+    static G4bool enabled_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
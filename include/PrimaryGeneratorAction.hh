@@ -50,7 +50,7 @@ namespace B1
   class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
   {
   public:
-    PrimaryGeneratorAction();
+    PrimaryGeneratorAction(const std::string &input_file);
     ~PrimaryGeneratorAction() override;
 
     // method from the base class
@@ -58,6 +58,8 @@ namespace B1
 
     // method to access particle gun
     const G4ParticleGun *GetParticleGun() const { return fParticleGun; }
+    // row of the generator input used by the next event
+    u_int64_t GetCursor() const { return fProtonGenerator->GetCursor(); }
 
   private:
     G4ParticleGun *fParticleGun = nullptr; // pointer a to G4 gun class
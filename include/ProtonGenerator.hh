@@ -12,6 +12,9 @@ public:
     int ReadFile(std::string fname);
     void Clear();
     void SetParticle(G4ThreeVector &vec, double &energy, G4ThreeVector &position);
+    u_int64_t GetCursor() const { return itr_; }
+    u_int64_t GetNumberOfRows() const { return en_p_.size(); }
+    void SetCursor(u_int64_t cursor) { itr_ = cursor; }
 
 protected:
     u_int64_t itr_;
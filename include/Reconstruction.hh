@@ -0,0 +1,70 @@
+/// \file B1/include/Reconstruction.hh
+/// \brief Definition of the B1::Reconstruction class
+
+#ifndef B1Reconstruction_h
+#define B1Reconstruction_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+/// Strip clustering and dE-E pairing of an event (--reco).
+///
+/// Runs in EndOfEventAction on the per-event deposits of the EventAction.
+/// Adjacent strips above kSiStripThreshold form a cluster with an
+/// energy-weighted centroid. Each cluster becomes a particle candidate with
+/// the front Si deposit as dE and, as E, the CsI crystal above kCsIThreshold
+/// behind the half of the strip plane the centroid is on (crystals 0 and 1
+/// above the middle, 2 and 3 below; the most energetic if both fired).
+///
+/// The candidates are written to <prefix>/reco; with --reco-only the raw
+/// eDep hits are not recorded.
+
+namespace B1
+{
+
+  /// Particle candidate of a strip cluster
+  struct RecoHit
+  {
+    G4int firstStrip = 0;
+    G4int nStrips = 0;
+    /// Energy-weighted strip number and position along the strips, local frame
+    G4double centroid = 0.;
+    G4double y = 0.;
+    G4double eStrips = 0.;
+    /// Front Si deposit, 0 below threshold
+    G4double eFront = 0.;
+    /// CsI crystal copy number, -1 if the particle stopped in the Si
+    G4int csiId = -1;
+    G4double eCsI = 0.;
+    /// Clusters of the event
+    G4int multiplicity = 0;
+
+    G4double ETotal() const { return eFront + eStrips + eCsI; }
+  };
+
+  class Reconstruction
+  {
+  public:
+    static void SetEnabled(G4bool enabled) { enabled_ = enabled; }
+    static G4bool IsEnabled() { return enabled_; }
+    /// Whether the raw eDep hits are recorded
+    static void SetRawHits(G4bool rawHits) { raw_hits_ = rawHits; }
+    static G4bool RawHits() { return raw_hits_; }
+
+    /// Clusters the strips (ordered by copy number) and pairs the clusters
+    /// with the front Si and CsI deposits; hits is cleared first
+    static void Reconstruct(const std::map<int, double> &strips, G4double eFront,
+                            const std::map<int, double> &csi, std::vector<RecoHit> &hits);
+
+  private:
+    static G4bool enabled_;
+    static G4bool raw_hits_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
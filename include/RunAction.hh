@@ -32,13 +32,18 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
+#include "G4Timer.hh"
 #include "globals.hh"
 
 #include <map>
+#include <memory>
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 #include <parquet/arrow/writer.h>
 
+#include "CheckpointManager.hh"
+#include "Reconstruction.hh"
+#include "WorkerMemoryPool.hh"
 #include "ExpConstants.hh"
 class G4Run;
 
@@ -54,23 +59,95 @@ namespace B1
   class RunAction : public G4UserRunAction
   {
   public:
+    /// Hits per event reserved before a worker has measured its own
+    static constexpr G4double kDefaultHitsPerEvent = 3.;
+    /// Upper limit of the builder reservation of a worker
+    static constexpr G4double kMaxReservedBytes = 256. * 1048576.;
+
     RunAction(const std::string &file_prefix);
     ~RunAction() {};
 
     void BeginOfRunAction(const G4Run *) override;
     void EndOfRunAction(const G4Run *) override;
 
-    void IncrementEvent() { ++n_worker_event_; }
+    /// Creates empty column builders for the worker
+    void InitializeBuilders(int workerId);
+    /// Finishes the column builders and writes the tables, with the
+    /// batches finished before, as Parquet files; the eDep table only with
+    /// raw hits, the reco and truth tables only with a file and
+    /// Reconstruction or TruthRecorder enabled. moreEvents reserves new
+    /// builders for the events after a checkpoint; the final flush of a run
+    /// leaves that to the next InitializeBuilders().
+    void WriteTables(const std::string &eDepFile, const std::string &evtInfoFile,
+                     const std::string &recoFile = "", const std::string &truthFile = "",
+                     G4bool moreEvents = false);
+
+    static std::shared_ptr<arrow::Schema> EDepSchema();
+    static std::shared_ptr<arrow::Schema> EvtInfoSchema();
+    static std::shared_ptr<arrow::Schema> RecoSchema();
+
+    /// Global ID of the event the next rows belong to
+    void SetEventId(int64_t eventId) { event_id_ = eventId; }
+    void IncrementEvent() { ++n_run_events_; }
+    void AddSteps(G4long nSteps) { n_steps_ += nSteps; }
+    /// Wall time of an event, merged into the event cost of EventBatching
+    void AddEventTime(G4double seconds) { event_seconds_ += seconds; }
+    /// Called after an event is recorded; cuts a record batch every
+    /// IpcStreamSink batch and writes a checkpoint every CheckpointManager
+    /// interval events
+    void EventDone(int64_t eventId);
+    /// Publishes the counters of the run to the telemetry, see Telemetry
+    void PublishTelemetry() const;
     void AddEdep(const std::string &detName, const G4double &eDep, G4int copyNum);
     void AddEventInfo(const G4double &energy, const G4double &theta, const G4double &phi);
+    void AddRecoHit(const RecoHit &hit);
 
   private:
+    /// Creates the builders with room for the expected events and hits
+    void CreateBuilders();
+    /// Moves the rows of the builders into record batches, published to the
+    /// stream if enabled, and creates new builders if more events follow
+    void FinishBatch(G4bool moreEvents = true);
+    /// Events and hits to reserve for the run of the worker
+    void ComputeReservation(G4long eventsPerWorker);
+    /// Flushes the builders to the next part files and commits the events
+    /// completed since the last checkpoint
+    void WriteCheckpoint(G4bool moreEvents);
+    /// Writes events, steps and run time of the global run to
+    /// <prefix>/run_stats.txt for the benchmark drivers
+    void WriteRunStats(G4int nofEvents) const;
+
     const std::string file_prefix_;
-    u_int64_t n_worker_event_;
+    // partition of the output, see RunMetadata
+    G4int run_id_ = 0;
+    int64_t event_id_ = 0;
+    // counters of the current run and bytes held by the builders
+    u_int64_t n_run_events_ = 0;
+    u_int64_t n_run_hits_ = 0;
+    u_int64_t buffered_bytes_ = 0;
+    // checkpoint state of the worker
+    G4int part_ = 0;
+    G4int events_since_checkpoint_ = 0;
+    std::vector<CheckpointManager::EventRange> pending_ranges_;
     int worker_id_;
+    // builder reservation and the measured hits per event of the worker
+    G4long reserved_events_ = 0;
+    G4long reserved_hits_ = 0;
+    G4double hits_per_event_ = kDefaultHitsPerEvent;
+    // declared before the builders and batches, which free into it
+    std::unique_ptr<WorkerMemoryPool> worker_pool_;
+    arrow::MemoryPool *pool_;
     std::map<std::string, std::shared_ptr<arrow::ArrayBuilder>> builder_map_;
     std::map<std::string, std::shared_ptr<arrow::ArrayBuilder>> event_info_builder_map_;
-    arrow::MemoryPool *pool_;
+    std::map<std::string, std::shared_ptr<arrow::ArrayBuilder>> reco_builder_map_;
+    // finished rows of the tables not written yet
+    std::vector<std::shared_ptr<arrow::RecordBatch>> eDep_batches_;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> evt_info_batches_;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> reco_batches_;
+    G4int events_in_batch_ = 0;
+    G4Accumulable<G4long> n_steps_ = 0;
+    G4Accumulable<G4double> event_seconds_ = 0.;
+    G4Timer timer_;
   };
 
 }
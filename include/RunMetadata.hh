@@ -0,0 +1,51 @@
+/// \file B1/include/RunMetadata.hh
+/// \brief Definition of the B1::RunMetadata class
+
+#ifndef B1RunMetadata_h
+#define B1RunMetadata_h 1
+
+#include "globals.hh"
+
+#include <arrow/api.h>
+
+#include <memory>
+#include <string>
+
+class G4ParticleGun;
+
+/// Run partitioning and configuration metadata of the output files.
+///
+/// Every run of a job writes its tables below <prefix>/<table>/run=<ID>, so
+/// a macro with several /run/beamOn keeps the output of all runs; the
+/// directory names follow the Hive convention, so an Arrow dataset of the
+/// table gets a run column. The Parquet key-value metadata of each file
+/// carries the configuration of its run (keys prefixed "octupole."): job
+/// entries such as the physics list and input file, the run ID, the master
+/// engine state the event seeds derive from (as /random/setSeeds left it)
+/// and their base seed, the particle of the gun, and the geometry constants
+/// of ExpConstants in mm and deg. The primary energy of each event is in
+/// evtInfo.
+
+namespace B1
+{
+
+  class RunMetadata
+  {
+  public:
+    /// Job entry, set before the first run
+    static void Set(const std::string &key, const std::string &value);
+    /// Run entries, from the master BeginOfRunAction after EventSeeder::BeginRun
+    static void BeginRun(G4int runId);
+
+    /// Metadata of a file of the worker
+    static std::shared_ptr<const arrow::KeyValueMetadata> Make(G4int workerId, const G4ParticleGun *gun);
+
+    /// <prefix>/<table>/run=<runId>
+    static std::string PartitionDir(const std::string &prefix, const std::string &table, G4int runId);
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
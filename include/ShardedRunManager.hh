@@ -0,0 +1,40 @@
+/// \file B1/include/ShardedRunManager.hh
+/// \brief Definition of the B1::ShardedRunManager class
+
+#ifndef B1ShardedRunManager_h
+#define B1ShardedRunManager_h 1
+
+#include "Sharding.hh"
+
+/// Run manager that runs only the events of this shard.
+///
+/// /run/beamOn T of shard i/N simulates the events of the shard only (see
+/// Sharding) instead of all T. Without sharding it behaves as its base.
+
+namespace B1
+{
+
+  template <class RunManager>
+  class ShardedRunManager : public RunManager
+  {
+  public:
+    using RunManager::RunManager;
+
+    void BeamOn(G4int nEvent, const char *macroFile = nullptr, G4int nSelect = -1) override
+    {
+      if (!Sharding::IsEnabled())
+      {
+        RunManager::BeamOn(nEvent, macroFile, nSelect);
+        return;
+      }
+      // the ID the run is about to get
+      RunManager::BeamOn(Sharding::BeginRun(nEvent, this->runIDCounter), macroFile, nSelect);
+      Sharding::EndRun();
+    }
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,74 @@
+/// \file B1/include/Sharding.hh
+/// \brief Definition of the B1::Sharding class
+
+#ifndef B1Sharding_h
+#define B1Sharding_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/// Multi-process sharding of a run (--shard i/N).
+///
+/// Shard i of N simulates the global events [i*T/N, (i+1)*T/N) of a
+/// /run/beamOn T: its run has (i+1)*T/N - i*T/N events whose IDs are offset
+/// by i*T/N (see ShardedRunManager). Seeds and input rows follow from the
+/// global event ID (EventSeeder), so the shards together produce the events
+/// of the unsharded run, whatever the number of shards.
+///
+/// Shard i writes its usual output layout to <prefix>/shard<i>of<N>, with a
+/// run=<R>/shard.txt per run describing its range and whether it completed.
+/// Every shard also writes the same <prefix>/run=<R>/dataset.txt listing all
+/// shards of the run, so a reader can treat the prefix as one dataset and
+/// check that all shards completed each run of a multi-run macro.
+
+namespace B1
+{
+
+  class Sharding
+  {
+  public:
+    /// Parses "i/N" with 0 <= i < N; false if malformed
+    static G4bool ParseSpec(const std::string &spec, G4int &index, G4int &count);
+
+    static void Configure(G4int index, G4int count, const std::string &datasetPrefix);
+    static G4bool IsEnabled() { return count_ > 0; }
+    static G4int GetIndex() { return index_; }
+    static G4int GetCount() { return count_; }
+
+    /// Output prefix of a shard inside the dataset prefix
+    static std::string ShardPrefix(const std::string &datasetPrefix, G4int index, G4int count);
+    /// First global event ID and number of events of a shard for a run of nTotal events
+    static std::pair<int64_t, int64_t> Range(int64_t nTotal, G4int index, G4int count);
+
+    /// Master, before the run of this shard: sets the event ID offset and
+    /// writes the manifests of the run. Returns the number of events of the
+    /// shard.
+    static G4int BeginRun(G4int nTotal, G4int runId);
+    /// Master, after the run: marks the shard complete
+    static void EndRun();
+
+    /// Added to the G4Event IDs of this process
+    static int64_t GetEventIdOffset() { return event_id_offset_; }
+
+  private:
+    /// Directory of the manifests of the current run below a prefix
+    static std::string RunDir(const std::string &prefix);
+    static void WriteShardFile(G4bool complete);
+    static void WriteDatasetFile();
+
+    static G4int index_;
+    static G4int count_;
+    static std::string dataset_prefix_;
+    static int64_t n_total_;
+    static int64_t event_id_offset_;
+    static G4int run_id_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,78 @@
+/// \file B1/include/StepCensus.hh
+/// \brief Definition of the B1::StepCensus class
+
+#ifndef B1StepCensus_h
+#define B1StepCensus_h 1
+
+#include "globals.hh"
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4Step;
+class G4VProcess;
+
+/// Step census by (logical volume, particle, creator process).
+///
+/// When enabled (--step-census), the stepping action records every step in a
+/// fixed-size thread-local table: the number of steps, the number of tracks
+/// (first steps) and the ticks since the previous step of the thread, which
+/// approximates the CPU time of the step. Each worker merges its table into
+/// the master at the end of its run; the master writes the combinations
+/// sorted by steps to <prefix>/step_census.txt and prints the first ones.
+/// Combinations that do not fit in the table are counted as "overflow".
+
+namespace B1
+{
+
+  class StepCensus
+  {
+  public:
+    static void SetEnabled(G4bool enabled) { enabled_ = enabled; }
+    static G4bool IsEnabled() { return enabled_; }
+
+    /// Census of the calling thread
+    static StepCensus &Instance();
+
+    /// Starts the step timing of an event
+    void BeginEvent();
+    void Record(const G4Step *step);
+
+    /// Adds the table of the calling thread to the master totals and clears it
+    void MergeToMaster();
+
+    static void ResetMaster();
+    /// Prints the nLines combinations with the most steps
+    static void PrintMaster(std::ostream &os, int nLines = 10);
+    static void WriteMaster(const std::string &fname);
+
+  private:
+    static constexpr int kTableSize = 4096; // power of two
+
+    struct Entry
+    {
+      const G4LogicalVolume *volume = nullptr;
+      const G4ParticleDefinition *particle = nullptr;
+      const G4VProcess *creator = nullptr;
+      uint64_t steps = 0;
+      uint64_t tracks = 0;
+      uint64_t ticks = 0;
+    };
+
+    Entry *Find(const G4LogicalVolume *volume, const G4ParticleDefinition *particle, const G4VProcess *creator);
+
+    static G4bool enabled_;
+    std::array<Entry, kTableSize> table_;
+    Entry overflow_;
+    uint64_t last_ticks_ = 0;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
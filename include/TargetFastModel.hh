@@ -0,0 +1,79 @@
+/// \file B1/include/TargetFastModel.hh
+/// \brief Definition of the B1::TargetFastModel class
+
+#ifndef B1TargetFastModel_h
+#define B1TargetFastModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Material;
+class G4Region;
+
+/// Thin-target transport shortcut for protons (--fast-target).
+///
+/// The 50 um polyethylene target is thin enough that a proton crosses it in
+/// one straight line: instead of stepping it through with multiple
+/// scattering and energy-loss fluctuations, the model moves it in a single
+/// step from its position in the target (the vertex depth of the
+/// ProtonGenerator for the primaries) to the target surface along its
+/// direction, and hands it over there with
+///  - the mean energy loss over the path length from the CSDA range table,
+///  - a Gaussian energy-loss straggling (the Bohr variance with the
+///    relativistic correction, the Gaussian regime of G4UniversalFluctuation),
+///  - Gaussian projected angles with the Highland width.
+/// The lateral displacement inside the target (below a micrometre) is
+/// neglected, delta rays and nuclear interactions in the target are not
+/// produced; the energy loss is deposited in the target. A proton whose
+/// range is shorter than its path stops at the end of its range.
+///
+/// The range and straggling tables are built per worker, for the material
+/// of the envelope, on the first proton, with the unrestricted dE/dx of the
+/// physics list (G4EmCalculator). Protons outside the table energies are
+/// left to the full transport. bench/compare_fast_target.sh compares the
+/// spectra with the full transport.
+
+namespace B1
+{
+
+  class TargetFastModel : public G4VFastSimulationModel
+  {
+  public:
+    static void SetEnabled(G4bool enabled) { enabled_ = enabled; }
+    static G4bool IsEnabled() { return enabled_; }
+
+    /// Attaches the model to the envelope region; thread-local, one per worker
+    TargetFastModel(const G4String &name, G4Region *envelope);
+    ~TargetFastModel() override = default;
+
+    G4bool IsApplicable(const G4ParticleDefinition &particle) override;
+    G4bool ModelTrigger(const G4FastTrack &fastTrack) override;
+    void DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep) override;
+
+  private:
+    void BuildTables(const G4Material *material);
+    /// Interpolation of the tables, energies within the table range
+    G4double Range(G4double energy) const;
+    G4double EnergyAtRange(G4double range) const;
+    G4double StragglingRate(G4double energy) const;
+    /// Highland width of the projected angle over path length
+    G4double ScatteringWidth(G4double energy, G4double length) const;
+
+    static G4bool enabled_;
+
+    const G4Material *material_ = nullptr;
+    G4double proton_mass_ = 0.;
+    G4double radiation_length_ = 0.;
+    /// Logarithmic energy grid, CSDA range and straggling variance per length
+    std::vector<G4double> log_energies_;
+    std::vector<G4double> log_ranges_;
+    std::vector<G4double> straggling_rates_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,52 @@
+/// \file B1/include/Telemetry.hh
+/// \brief Definition of the B1::Telemetry class
+
+#ifndef B1Telemetry_h
+#define B1Telemetry_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <string>
+
+/// Live run telemetry.
+///
+/// Workers publish their per-run counters (events, hits, bytes buffered in
+/// the Arrow builders) into a per-thread slot with relaxed atomic stores
+/// after each event. During a run a master thread samples the slots every
+/// interval and publishes one JSON line per sample with the total rate,
+/// the ETA, the process RSS and the per-worker counters, plus warnings for
+/// stuck or slow workers and for runaway output buffering.
+///
+/// The destination is a file the lines are appended to (tail -f friendly),
+/// or "unix:<path>" to send each line as a datagram to a Unix socket.
+/// Telemetry is off unless a destination is configured (--telemetry).
+
+namespace B1
+{
+
+  class Telemetry
+  {
+  public:
+    static constexpr int kMaxWorkers = 256;
+
+    static void Configure(const std::string &destination, G4double interval);
+    static G4bool IsEnabled() { return enabled_; }
+
+    /// Called by the worker after each event with its counters of the run
+    static void Publish(G4int workerId, uint64_t events, uint64_t hits, uint64_t bufferedBytes);
+
+    /// Starts the sampling thread, from the master BeginOfRunAction
+    static void StartRun(uint64_t eventsToProcess);
+    /// Publishes a last sample and stops the sampling thread
+    static void StopRun();
+
+  private:
+    static G4bool enabled_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,59 @@
+/// \file B1/include/ThreadPlacement.hh
+/// \brief Definition of the B1::ThreadPlacement class
+
+#ifndef B1ThreadPlacement_h
+#define B1ThreadPlacement_h 1
+
+#include "globals.hh"
+
+#include <string>
+#include <vector>
+
+/// Pinning of the worker threads to CPUs (--pin <layout>).
+///
+/// Layouts:
+///   none     threads float (default)
+///   compact  fill the CPUs of NUMA node 0 first, then node 1, ...
+///   scatter  alternate the NUMA nodes, worker 0 on node 0, 1 on node 1, ...
+///   <list>   explicit CPUs in worker order, e.g. 0-9,20-29
+///
+/// Workers beyond the number of CPUs wrap around. Only CPUs the process may
+/// run on are used; the NUMA topology is read from /sys/devices/system/node.
+///
+/// A worker is pinned in WorkerInitialize(), before its user actions are
+/// built, so that with the default local allocation policy its generator
+/// input and output builders are first touched, hence placed, on its own
+/// node. The builders then allocate from the system allocator, whose
+/// per-thread arenas keep reusing that memory, rather than from the shared
+/// pool of Arrow.
+
+namespace B1
+{
+
+  class ThreadPlacement
+  {
+  public:
+    /// Master, before the workers start; false for an unknown layout
+    static G4bool Configure(const std::string &layout);
+    static G4bool IsEnabled() { return !cpus_.empty(); }
+
+    /// Pins the calling thread to the CPU of the worker
+    static void PinWorker(G4int workerId);
+
+    /// CPUs of a list such as "0-3,8,10-11" in the given order, empty if malformed
+    static std::vector<G4int> ParseCpuList(const std::string &list);
+
+  private:
+    // CPUs of each NUMA node the process may run on
+    static std::vector<std::vector<G4int>> ReadNodes();
+
+    // CPU and NUMA node per worker, wrapping around
+    static std::vector<G4int> cpus_;
+    static std::vector<G4int> nodes_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
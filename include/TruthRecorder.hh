@@ -0,0 +1,105 @@
+/// \file B1/include/TruthRecorder.hh
+/// \brief Definition of the B1::TruthRecorder class
+
+#ifndef B1TruthRecorder_h
+#define B1TruthRecorder_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class G4Step;
+
+/// Truth tracks of a sample of the events (--truth <fraction>).
+///
+/// For a sampled event the stepping action records the primary tracks, and
+/// with --truth-secondaries all tracks, as a list of points: the start of
+/// the track, every entry into and exit from a detector volume (front Si,
+/// Si strips, CsI) and the point where the track stopped or left the world,
+/// each with position and kinetic energy, so the residual energy is the
+/// energy of the last point. The points go to a thread-local arena that
+/// keeps its capacity between flushes.
+///
+/// Each worker writes one row per track to the run partition of
+/// <prefix>/truth with the points as list columns, next to its eDep and
+/// evtInfo files (and parts, with checkpoints). Events are sampled by a
+/// hash of their global event ID, so the Geant4 random numbers and hence
+/// the physics are unchanged and the same events are recorded whatever the
+/// threads. Disabled, the stepping action only tests a static flag;
+/// enabled, an event that is not sampled costs one thread-local test per
+/// step.
+
+namespace B1
+{
+
+  class TruthRecorder
+  {
+  public:
+    /// Point kinds
+    enum Kind : int8_t
+    {
+      kStart,
+      kEntry,
+      kExit,
+      kStop
+    };
+    /// Volume codes of the points
+    enum Volume : int8_t
+    {
+      kWorld,
+      kFrontSi,
+      kSiStrip,
+      kCsI
+    };
+
+    /// A fraction of 0 disables the recorder
+    static void Configure(G4double fraction, G4bool secondaries);
+    static G4bool IsEnabled() { return enabled_; }
+    static std::shared_ptr<arrow::Schema> Schema();
+
+    /// Recorder of the calling thread
+    static TruthRecorder &Instance();
+
+    /// Samples the event
+    void BeginEvent(int64_t eventId);
+    G4bool IsRecording() const { return recording_; }
+    void Record(const G4Step *step);
+
+    /// Moves the tracks recorded since the last call into a table
+    std::shared_ptr<arrow::Table> Finish(G4int workerId, arrow::MemoryPool *pool);
+
+  private:
+    void AddPoint(Kind kind, Volume volume, G4int copyId, const G4ThreeVector &position, G4double eKin);
+
+    static G4bool enabled_;
+    static G4bool secondaries_;
+    /// Events with a sampling hash below it are recorded
+    static uint64_t threshold_;
+
+    G4bool recording_ = false;
+    int64_t event_id_ = 0;
+    G4int track_id_ = 0;
+    // one entry per track
+    std::vector<int64_t> event_ids_;
+    std::vector<int32_t> track_ids_;
+    std::vector<int32_t> parent_ids_;
+    std::vector<int32_t> pdg_codes_;
+    std::vector<int32_t> offsets_ = {0};
+    // one entry per point
+    std::vector<int8_t> kinds_;
+    std::vector<int8_t> volumes_;
+    std::vector<int16_t> copy_ids_;
+    std::vector<float> x_, y_, z_;
+    std::vector<float> e_kin_;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
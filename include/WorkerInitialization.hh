@@ -0,0 +1,30 @@
+/// \file B1/include/WorkerInitialization.hh
+/// \brief Definition of the B1::WorkerInitialization class
+
+#ifndef B1WorkerInitialization_h
+#define B1WorkerInitialization_h 1
+
+#include "G4UserWorkerInitialization.hh"
+
+/// Worker thread initialization
+///
+/// Pins each worker thread (see ThreadPlacement) before its user actions
+/// are built.
+
+namespace B1
+{
+
+  class WorkerInitialization : public G4UserWorkerInitialization
+  {
+  public:
+    WorkerInitialization() = default;
+    ~WorkerInitialization() override = default;
+
+    void WorkerInitialize() const override;
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,82 @@
+/// \file B1/include/WorkerMemoryPool.hh
+/// \brief Definition of the B1::WorkerMemoryPool class
+
+#ifndef B1WorkerMemoryPool_h
+#define B1WorkerMemoryPool_h 1
+
+#include "globals.hh"
+
+#include <arrow/memory_pool.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// Arrow memory pool of one worker.
+///
+/// Forwards to mimalloc or jemalloc when Arrow was built with them, to the
+/// system allocator otherwise or when the workers are pinned (see
+/// ThreadPlacement). The pool counts its allocations and reallocations and
+/// keeps the peak of the bytes allocated. The worker allocates, but the
+/// batches it hands to IpcStreamSink are freed by the writer thread or by
+/// other workers, so the counters are relaxed atomics. The counts of the
+/// workers are summed in the master at the end of the run and printed with
+/// the run summary; reallocations are the copies the builder reservations
+/// of RunAction should avoid.
+
+namespace B1
+{
+
+  class WorkerMemoryPool : public arrow::MemoryPool
+  {
+  public:
+    struct Stats
+    {
+      int64_t allocations = 0;
+      int64_t reallocations = 0;
+      /// Bytes held before each reallocation, an upper bound of the copies
+      int64_t reallocatedBytes = 0;
+      /// Of a worker; the largest worker peak in the master statistics
+      int64_t peakBytes = 0;
+    };
+
+    WorkerMemoryPool(G4bool systemAllocator);
+
+    arrow::Status Allocate(int64_t size, int64_t alignment, uint8_t **out) override;
+    arrow::Status Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t **ptr) override;
+    void Free(uint8_t *buffer, int64_t size, int64_t alignment) override;
+    void ReleaseUnused() override { backend_->ReleaseUnused(); }
+    int64_t bytes_allocated() const override { return bytes_.load(std::memory_order_relaxed); }
+    int64_t max_memory() const override { return peak_bytes_.load(std::memory_order_relaxed); }
+    // pure virtual in recent Arrow versions only, hence no override
+    int64_t total_bytes_allocated() const { return total_bytes_.load(std::memory_order_relaxed); }
+    int64_t num_allocations() const { return allocations_.load(std::memory_order_relaxed); }
+    std::string backend_name() const override { return backend_->backend_name(); }
+
+    /// Snapshot of the counters
+    Stats GetStats() const;
+    /// Adds the counts to the master and restarts them, keeping the current
+    /// allocation as the new peak
+    void MergeToMaster();
+
+    static void ResetMaster();
+    static void PrintMaster(std::ostream &os);
+
+  private:
+    void UpdatePeak(int64_t bytes);
+
+    arrow::MemoryPool *backend_;
+    std::atomic<int64_t> bytes_{0};
+    std::atomic<int64_t> total_bytes_{0};
+    std::atomic<int64_t> allocations_{0};
+    std::atomic<int64_t> reallocations_{0};
+    std::atomic<int64_t> reallocated_bytes_{0};
+    std::atomic<int64_t> peak_bytes_{0};
+  };
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,34 @@
+/// \file octupole_batch.cc
+/// \brief Batch-only main program, without UI session and visualization
+///
+///   octupole_batch [-t threads] [-o outputPrefix] [-i inputFile] [-p physicsList] macro
+///
+/// Links only the Geant4 kernel and physics list libraries so that batch
+/// jobs do not pay for loading and initializing the UI and vis drivers.
+
+#include "Application.hh"
+#include "AppOptions.hh"
+
+using namespace B1;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char **argv)
+{
+  AppOptions options;
+  if (!options.Parse(argc, argv))
+    return 1;
+  if (options.macro.empty())
+  {
+    options.PrintUsage(argv[0]);
+    return 1;
+  }
+
+  Application application(options);
+  if (!application.IsValid())
+    return 1;
+  application.ExecuteMacro();
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -40,7 +40,7 @@ namespace B1
 
   void ActionInitialization::BuildForMaster() const
   {
-    auto runAction = new RunAction(file_prefix_);
+    auto runAction = new RunAction(options_.outputPrefix);
     SetUserAction(runAction);
   }
 
@@ -48,10 +48,12 @@ namespace B1
 
   void ActionInitialization::Build() const
   {
-    SetUserAction(new PrimaryGeneratorAction);
+    SetUserAction(new PrimaryGeneratorAction(options_.inputFile));
 
-    auto runAction = std::make_shared<RunAction>(file_prefix_);
-    SetUserAction(runAction.get());
+    // the user actions are owned by the worker run manager, which with the
+    // tasking run manager lives as long as its pool thread
+    auto runAction = new RunAction(options_.outputPrefix);
+    SetUserAction(runAction);
 
     auto eventAction = new EventAction(runAction);
     SetUserAction(eventAction);
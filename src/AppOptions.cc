@@ -0,0 +1,220 @@
+/// \file B1/src/AppOptions.cc
+/// \brief Implementation of the B1::AppOptions class
+
+#include "AppOptions.hh"
+#include "OutputLayout.hh"
+#include "Sharding.hh"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  bool AppOptions::Parse(int argc, char **argv)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const char *arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if ((!std::strcmp(arg, "-p") || !std::strcmp(arg, "--physics")) && hasValue)
+      {
+        physicsList = argv[++i];
+      }
+      else if ((!std::strcmp(arg, "-o") || !std::strcmp(arg, "--output")) && hasValue)
+      {
+        outputPrefix = argv[++i];
+      }
+      else if ((!std::strcmp(arg, "-i") || !std::strcmp(arg, "--input")) && hasValue)
+      {
+        inputFile = argv[++i];
+      }
+      else if ((!std::strcmp(arg, "-t") || !std::strcmp(arg, "--threads")) && hasValue)
+      {
+        nThreads = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--run-manager") && hasValue)
+      {
+        runManager = argv[++i];
+        if (runManager != "tasking" && runManager != "mt")
+        {
+          G4cerr << "Invalid run manager " << runManager << ", expected mt or tasking" << G4endl;
+          return false;
+        }
+      }
+      else if (!std::strcmp(arg, "--event-batch") && hasValue)
+      {
+        eventBatch = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--truth") && hasValue)
+      {
+        truthFraction = std::atof(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--truth-secondaries"))
+      {
+        truthSecondaries = true;
+      }
+      else if (!std::strcmp(arg, "--precision") && hasValue)
+      {
+        precision = std::atof(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--target") && hasValue)
+      {
+        precisionTarget = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--pin") && hasValue)
+      {
+        pin = argv[++i];
+      }
+      else if ((!std::strcmp(arg, "-m") || !std::strcmp(arg, "--macro")) && hasValue)
+      {
+        macro = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--macro-path") && hasValue)
+      {
+        macroPath = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--telemetry") && hasValue)
+      {
+        telemetry = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--telemetry-interval") && hasValue)
+      {
+        telemetryInterval = std::atof(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--stream") && hasValue)
+      {
+        stream = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--stream-policy") && hasValue)
+      {
+        streamPolicy = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--stream-queue") && hasValue)
+      {
+        streamQueue = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--stream-batch") && hasValue)
+      {
+        streamBatch = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--checkpoint") && hasValue)
+      {
+        checkpointInterval = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--resume"))
+      {
+        resume = true;
+      }
+      else if (!std::strcmp(arg, "--shard") && hasValue)
+      {
+        if (!Sharding::ParseSpec(argv[++i], shardIndex, shardCount))
+        {
+          G4cerr << "Invalid shard " << argv[i] << ", expected i/N with 0 <= i < N" << G4endl;
+          return false;
+        }
+      }
+      else if (!std::strcmp(arg, "--step-census"))
+      {
+        stepCensus = true;
+      }
+      else if (!std::strcmp(arg, "--reco"))
+      {
+        reco = true;
+      }
+      else if (!std::strcmp(arg, "--reco-only"))
+      {
+        reco = true;
+        recoOnly = true;
+      }
+      else if (!std::strcmp(arg, "--sort") && hasValue)
+      {
+        sortOrder = argv[++i];
+      }
+      else if (!std::strcmp(arg, "--row-group") && hasValue)
+      {
+        rowGroupRows = std::atoi(argv[++i]);
+      }
+      else if (!std::strcmp(arg, "--bloom"))
+      {
+        bloomFilters = true;
+      }
+      else if (!std::strcmp(arg, "--fast-target"))
+      {
+        fastTarget = true;
+      }
+      else if (arg[0] != '-' && macro.empty())
+      {
+        macro = arg;
+      }
+      else
+      {
+        PrintUsage(argv[0]);
+        return false;
+      }
+    }
+    // a resumed job keeps writing checkpoints
+    if (resume && checkpointInterval <= 0)
+      checkpointInterval = kDefaultCheckpointInterval;
+    // each shard writes below the dataset prefix
+    if (shardCount > 0)
+    {
+      datasetPrefix = outputPrefix;
+      outputPrefix = Sharding::ShardPrefix(datasetPrefix, shardIndex, shardCount);
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void AppOptions::PrintUsage(const char *program) const
+  {
+    G4cerr << "Usage: " << program << " [options] [macro]" << G4endl
+           << "  -p, --physics <name>  physics list: lean or a Geant4 reference list"
+           << " (default: $OCTUPOLE_PHYSICS_LIST or QBBC)" << G4endl
+           << "  -o, --output <prefix> output prefix (default: " << outputPrefix << ")" << G4endl
+           << "  -i, --input <file>    generator input file (default: " << inputFile << ")" << G4endl
+           << "  -t, --threads <n>     worker threads, overrides /run/numberOfThreads" << G4endl
+           << "  --run-manager <type>  mt, or tasking for work stealing (default: " << runManager << ")" << G4endl
+           << "  --event-batch <n>     events per batch (default: sized from the event cost)" << G4endl
+           << "  --truth <fraction>    record the truth tracks of a fraction of the events to <prefix>/truth"
+           << G4endl
+           << "  --truth-secondaries   also record the secondary tracks" << G4endl
+           << "  --precision <r>       stop each run at relative uncertainty r of the target fraction" << G4endl
+           << "  --target <quantity>   coincidence, strips:<a>-<b> or dee:<dE0>-<dE1>,<E0>-<E1> in MeV (default: "
+           << precisionTarget << ")" << G4endl
+           << "  --pin <layout>        pin workers: none, compact, scatter or a CPU list such as 0-9,20-29"
+           << G4endl
+           << "  -m, --macro <file>    macro file, same as the positional argument" << G4endl
+           << "  --macro-path <dirs>   colon separated macro search path" << G4endl
+           << "  --telemetry <dest>    live run telemetry, JSON lines to a file or unix:<socket>" << G4endl
+           << "  --telemetry-interval <s>  telemetry sampling interval (default: " << telemetryInterval << " s)"
+           << G4endl
+           << "  --stream <dest>       live Arrow IPC stream to fifo:<path> or unix:<path>" << G4endl
+           << "  --stream-policy <p>   full stream queue: drop, oldest or block (default: " << streamPolicy << ")"
+           << G4endl
+           << "  --stream-queue <n>    queued record batches per table (default: " << streamQueue << ")" << G4endl
+           << "  --stream-batch <n>    events per record batch (default: " << streamBatch << ")" << G4endl
+           << "  --checkpoint <n>      checkpoint every n events per worker" << G4endl
+           << "  --resume              continue from the checkpoint of the output prefix"
+           << " (checkpoints every " << kDefaultCheckpointInterval << " events unless --checkpoint)" << G4endl
+           << "  --shard <i/N>         run shard i of N of each /run/beamOn into <prefix>/shard<i>of<N>"
+           << G4endl
+           << "  --step-census         count steps per volume, particle and creator process" << G4endl
+           << "  --reco                write reconstructed strip clusters with dE-E to <prefix>/reco" << G4endl
+           << "  --reco-only           as --reco, without the raw eDep hits" << G4endl
+           << "  --sort <order>        sort the output rows by event or detector, with statistics and page indexes"
+           << G4endl
+           << "  --row-group <n>       rows per row group of the sorted output (default: "
+           << OutputLayout::kDefaultRowGroupRows << ")" << G4endl
+           << "  --bloom               bloom filters on eventId in the sorted output" << G4endl
+           << "  --fast-target         cross the target in one step with tabulated energy loss and scattering"
+           << G4endl
+           << "Without a macro exampleB1 starts an interactive session." << G4endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,146 @@
+/// \file B1/src/Application.cc
+/// \brief Implementation of the B1::Application class
+
+#include "Application.hh"
+#include "ActionInitialization.hh"
+#include "CheckpointManager.hh"
+#include "EventBatching.hh"
+#include "DetectorConstruction.hh"
+#include "IpcStreamSink.hh"
+#include "OutputLayout.hh"
+#include "PhysicsListSelector.hh"
+#include "PhysicsTableCache.hh"
+#include "PrecisionTarget.hh"
+#include "Reconstruction.hh"
+#include "RunAction.hh"
+#include "RunMetadata.hh"
+#include "ShardedRunManager.hh"
+#include "Sharding.hh"
+#include "StepCensus.hh"
+#include "TargetFastModel.hh"
+#include "ThreadPlacement.hh"
+#include "Telemetry.hh"
+#include "TruthRecorder.hh"
+#include "WorkerInitialization.hh"
+
+#include "G4MTRunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4UImanager.hh"
+#include "G4VModularPhysicsList.hh"
+
+#include <cstdlib>
+#include <string>
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  Application::Application(const AppOptions &options) : options_(options)
+  {
+    // A thread count from the command line takes precedence over the
+    // /run/numberOfThreads commands of the macros
+    if (options_.nThreads > 0)
+    {
+      setenv("G4FORCENUMBEROFTHREADS", std::to_string(options_.nThreads).c_str(), 1);
+    }
+
+    if (!ThreadPlacement::Configure(options_.pin))
+      return;
+    if (!PrecisionTarget::Configure(options_.precisionTarget, options_.precision))
+      return;
+    if (!OutputLayout::Configure(options_.sortOrder, options_.rowGroupRows, options_.bloomFilters))
+      return;
+    if (!IpcStreamSink::Configure(options_.stream, options_.streamPolicy, options_.streamQueue, options_.streamBatch,
+                                  RunAction::EDepSchema(), RunAction::EvtInfoSchema()))
+      return;
+
+    // Construct the run manager, which runs only the events of this shard
+    // with --shard
+    //
+    G4MTRunManager *runManager = nullptr;
+    if (options_.runManager == "tasking")
+      runManager = new ShardedRunManager<G4TaskRunManager>();
+    else
+      runManager = new ShardedRunManager<G4MTRunManager>();
+    runManager->SetNumberOfThreads(options_.nThreads > 0 ? options_.nThreads : 1);
+
+    //  Set mandatory initialization classes
+    //
+    //  Detector construction
+    runManager->SetUserInitialization(new DetectorConstruction());
+
+    // Physics list, with the fast simulation process for --fast-target
+    TargetFastModel::SetEnabled(options_.fastTarget);
+    const G4String physicsListName = SelectPhysicsListName(options_.physicsList);
+    G4VModularPhysicsList *physicsList = CreatePhysicsList(physicsListName);
+    if (!physicsList)
+    {
+      delete runManager;
+      return;
+    }
+    G4cout << "Physics list: " << physicsListName << G4endl;
+    physicsList->SetVerboseLevel(1);
+    runManager->SetUserInitialization(physicsList);
+
+    // Retrieve physics tables from the cache when physics list, materials and
+    // cuts match a previous job, otherwise build and store them
+    physics_table_cache_ = new PhysicsTableCache(physicsList, PhysicsTableCache::DefaultDirectory());
+
+    if (options_.shardCount > 0)
+      Sharding::Configure(options_.shardIndex, options_.shardCount, options_.datasetPrefix);
+    EventBatching::Configure(options_.eventBatch);
+    StepCensus::SetEnabled(options_.stepCensus);
+    Reconstruction::SetEnabled(options_.reco);
+    Reconstruction::SetRawHits(!options_.recoOnly);
+    TruthRecorder::Configure(options_.truthFraction, options_.truthSecondaries);
+    Telemetry::Configure(options_.telemetry, options_.telemetryInterval);
+    CheckpointManager::Instance().Configure(options_.checkpointInterval, options_.resume);
+
+    RunMetadata::Set("macro", options_.macro);
+    RunMetadata::Set("physicsList", physicsListName);
+    RunMetadata::Set("inputFile", options_.inputFile);
+    RunMetadata::Set("runManager", options_.runManager);
+    if (!options_.sortOrder.empty())
+      RunMetadata::Set("sort", options_.sortOrder);
+    if (options_.fastTarget)
+      RunMetadata::Set("fastTarget", "true");
+    if (options_.shardCount > 0)
+      RunMetadata::Set("shard", std::to_string(options_.shardIndex) + "/" + std::to_string(options_.shardCount));
+
+    if (ThreadPlacement::IsEnabled())
+      runManager->SetUserInitialization(new WorkerInitialization());
+
+    // User action initialization
+    runManager->SetUserInitialization(new ActionInitialization(options_));
+
+    run_manager_ = runManager;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  Application::~Application()
+  {
+    // user actions, physics list and detector construction are owned and
+    // deleted by the run manager
+    delete physics_table_cache_;
+    // the queued batches must go before the worker memory pools
+    IpcStreamSink::Shutdown();
+    delete run_manager_;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Application::ExecuteMacro() const
+  {
+    G4UImanager *UImanager = G4UImanager::GetUIpointer();
+    if (!options_.macroPath.empty())
+    {
+      UImanager->ApplyCommand("/control/macroPath " + options_.macroPath);
+    }
+    UImanager->ApplyCommand("/control/execute " + options_.macro);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
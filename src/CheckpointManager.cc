@@ -0,0 +1,318 @@
+/// \file B1/src/CheckpointManager.cc
+/// \brief Implementation of the B1::CheckpointManager class
+
+#include "CheckpointManager.hh"
+#include "RunMetadata.hh"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace B1
+{
+
+  namespace
+  {
+    const char *kManifestVersion = "octupoleCheckpoint 1";
+
+    std::string FormatRanges(const std::vector<CheckpointManager::EventRange> &ranges)
+    {
+      if (ranges.empty())
+        return "-";
+      std::ostringstream oss;
+      for (size_t i = 0; i < ranges.size(); ++i)
+        oss << (i ? "," : "") << ranges[i].first << "-" << ranges[i].second;
+      return oss.str();
+    }
+
+    std::vector<CheckpointManager::EventRange> ParseRanges(const std::string &text)
+    {
+      std::vector<CheckpointManager::EventRange> ranges;
+      std::istringstream iss(text);
+      std::string item;
+      while (std::getline(iss, item, ','))
+      {
+        const auto dash = item.find('-', 1);
+        if (dash == std::string::npos)
+          continue;
+        ranges.emplace_back(std::stoll(item.substr(0, dash)), std::stoll(item.substr(dash + 1)));
+      }
+      return ranges;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  CheckpointManager &CheckpointManager::Instance()
+  {
+    static CheckpointManager manager;
+    return manager;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::Configure(G4int interval, G4bool resume)
+  {
+    interval_ = interval > 0 ? interval : 0;
+    resuming_ = resume && interval_ > 0;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool CheckpointManager::BeginRun(const std::string &prefix, G4int runId, int64_t eventsToProcess)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prefix_ = prefix;
+    // one manifest per run, so a multi-run macro resumes in any of its runs
+    directory_ = prefix + "/checkpoint/run" + std::to_string(runId);
+    fs::create_directories(directory_);
+
+    // a run the previous attempt did not reach starts from scratch
+    if (resuming_ && fs::exists(directory_ + "/manifest.txt"))
+    {
+      if (!LoadManifest())
+        return false;
+      if (run_id_ != runId || events_to_process_ != eventsToProcess)
+      {
+        std::ostringstream message;
+        message << "Checkpoint in " << directory_ << " is for run " << run_id_ << " with " << events_to_process_
+                << " events, not run " << runId << " with " << eventsToProcess << " events.";
+        G4Exception("CheckpointManager::BeginRun", "Checkpoint001", FatalException, message);
+        return false;
+      }
+      DeleteOrphanParts();
+
+      skip_.clear();
+      if (complete_)
+      {
+        // all events of the run are in its committed parts
+        skip_.emplace_back(INT64_MIN, INT64_MAX);
+        G4cout << "Skipping run " << runId << ": completed by a previous attempt, see " << directory_ << G4endl;
+        return true;
+      }
+      int64_t nCompleted = 0;
+      for (const auto &worker : workers_)
+      {
+        skip_.insert(skip_.end(), worker.second.completed.begin(), worker.second.completed.end());
+      }
+      MergeRanges(skip_);
+      for (const auto &range : skip_)
+        nCompleted += range.second - range.first + 1;
+      G4cout << "Resuming run " << runId << " from " << directory_ << ": " << nCompleted << " of "
+             << eventsToProcess << " events completed" << G4endl;
+    }
+    else
+    {
+      run_id_ = runId;
+      events_to_process_ = eventsToProcess;
+      complete_ = false;
+      workers_.clear();
+      skip_.clear();
+      WriteManifest();
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::EndRun()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    complete_ = true;
+    WriteManifest();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool CheckpointManager::IsCompleted(int64_t eventId) const
+  {
+    if (skip_.empty())
+      return false;
+    // first range starting after the event, the one before may contain it
+    auto itr = std::upper_bound(skip_.begin(), skip_.end(), EventRange(eventId, INT64_MAX));
+    return itr != skip_.begin() && std::prev(itr)->second >= eventId;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  CheckpointManager::WorkerState CheckpointManager::GetWorkerState(G4int workerId) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto itr = workers_.find(workerId);
+    return itr != workers_.end() ? itr->second : WorkerState();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::Commit(G4int workerId, G4int parts, uint64_t cursor,
+                                 const std::vector<EventRange> &completed)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &state = workers_[workerId];
+    state.parts = parts;
+    state.cursor = cursor;
+    // after a resume a worker ID may get events below the ones it completed before
+    state.completed.insert(state.completed.end(), completed.begin(), completed.end());
+    MergeRanges(state.completed);
+    WriteManifest();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string CheckpointManager::EDepPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part)
+  {
+    return RunMetadata::PartitionDir(prefix, "eDep", runId) + "/worker" + std::to_string(workerId) + "_part" +
+           std::to_string(part) + ".parquet";
+  }
+
+  std::string CheckpointManager::EvtInfoPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part)
+  {
+    return RunMetadata::PartitionDir(prefix, "evtInfo", runId) + "/worker_" + std::to_string(workerId) + "_part" +
+           std::to_string(part) + ".parquet";
+  }
+
+  std::string CheckpointManager::RecoPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part)
+  {
+    return RunMetadata::PartitionDir(prefix, "reco", runId) + "/worker_" + std::to_string(workerId) + "_part" +
+           std::to_string(part) + ".parquet";
+  }
+
+  std::string CheckpointManager::TruthPartFile(const std::string &prefix, G4int runId, G4int workerId, G4int part)
+  {
+    return RunMetadata::PartitionDir(prefix, "truth", runId) + "/worker_" + std::to_string(workerId) + "_part" +
+           std::to_string(part) + ".parquet";
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::AddToRanges(std::vector<EventRange> &ranges, int64_t eventId)
+  {
+    if (!ranges.empty() && ranges.back().second + 1 == eventId)
+    {
+      ranges.back().second = eventId;
+      return;
+    }
+    ranges.emplace_back(eventId, eventId);
+    // out of order: not after the previous range
+    if (ranges.size() > 1 && ranges[ranges.size() - 2].second + 1 >= eventId)
+      MergeRanges(ranges);
+  }
+
+  void CheckpointManager::MergeRanges(std::vector<EventRange> &ranges)
+  {
+    std::sort(ranges.begin(), ranges.end());
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+      if (ranges[i].first <= ranges[last].second + 1)
+        ranges[last].second = std::max(ranges[last].second, ranges[i].second);
+      else
+        ranges[++last] = ranges[i];
+    }
+    if (!ranges.empty())
+      ranges.resize(last + 1);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool CheckpointManager::LoadManifest()
+  {
+    const std::string fname = directory_ + "/manifest.txt";
+    std::ifstream fin(fname);
+    std::string line;
+    if (!std::getline(fin, line) || line != kManifestVersion)
+    {
+      G4Exception("CheckpointManager::LoadManifest", "Checkpoint002", FatalException,
+                  ("No checkpoint manifest to resume from: " + fname).c_str());
+      return false;
+    }
+    workers_.clear();
+    while (std::getline(fin, line))
+    {
+      std::istringstream iss(line);
+      std::string key;
+      iss >> key;
+      if (key == "runId")
+        iss >> run_id_;
+      else if (key == "eventsToProcess")
+        iss >> events_to_process_;
+      else if (key == "complete")
+        iss >> complete_;
+      else if (key == "worker")
+      {
+        // worker <id> parts <n> cursor <c> completed <ranges>
+        G4int workerId;
+        std::string label, ranges;
+        WorkerState state;
+        iss >> workerId >> label >> state.parts >> label >> state.cursor >> label >> ranges;
+        state.completed = ParseRanges(ranges);
+        workers_[workerId] = state;
+      }
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::WriteManifest() const
+  {
+    const std::string fname = directory_ + "/manifest.txt";
+    const std::string tmpName = fname + ".tmp" + std::to_string(getpid());
+    {
+      std::ofstream fout(tmpName);
+      fout << kManifestVersion << "\n"
+           << "runId " << run_id_ << "\n"
+           << "eventsToProcess " << events_to_process_ << "\n"
+           << "complete " << complete_ << "\n";
+      for (const auto &worker : workers_)
+      {
+        fout << "worker " << worker.first << " parts " << worker.second.parts << " cursor " << worker.second.cursor
+             << " completed " << FormatRanges(worker.second.completed) << "\n";
+      }
+      if (!fout)
+      {
+        G4cerr << "Cannot write checkpoint manifest " << tmpName << G4endl;
+        return;
+      }
+    }
+    std::error_code ec;
+    fs::rename(tmpName, fname, ec);
+    if (ec)
+      G4cerr << "Cannot replace checkpoint manifest " << fname << ": " << ec.message() << G4endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckpointManager::DeleteOrphanParts() const
+  {
+    // parts written after the last commit of their worker
+    const std::regex partName("worker_?([0-9]+)_part([0-9]+)\\.parquet");
+    for (const char *table : {"eDep", "evtInfo", "reco", "truth"})
+    {
+      std::error_code ec;
+      for (const auto &entry : fs::directory_iterator(RunMetadata::PartitionDir(prefix_, table, run_id_), ec))
+      {
+        std::smatch match;
+        const std::string name = entry.path().filename().string();
+        if (!std::regex_match(name, match, partName))
+          continue;
+        const auto itr = workers_.find(std::stoi(match[1]));
+        const G4int committed = itr != workers_.end() ? itr->second.parts : 0;
+        if (std::stoi(match[2]) >= committed)
+        {
+          G4cout << "Removing uncommitted part " << entry.path().string() << G4endl;
+          fs::remove(entry.path());
+        }
+      }
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
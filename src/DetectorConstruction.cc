@@ -28,8 +28,14 @@
 /// \brief Implementation of the B1::DetectorConstruction class
 
 #include "DetectorConstruction.hh"
+#include "DetectorMessenger.hh"
+#include "TargetFastModel.hh"
 
 #include "G4RunManager.hh"
+#include "G4RunManagerKernel.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4StateManager.hh"
+#include "G4StepLimiterPhysics.hh"
 #include "G4NistManager.hh"
 #include "G4Box.hh"
 #include "G4Cons.hh"
@@ -43,12 +49,40 @@
 #include "ExpConstants.hh"
 #include "G4Material.hh"
 #include "G4VisAttributes.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4UserLimits.hh"
+#include "G4UnitsTable.hh"
 
 namespace B1
 {
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+  DetectorConstruction::DetectorConstruction()
+  {
+    regions_["target"] = {"Target", B1::kTargetCut};
+    regions_["frontSi"] = {"FrontSi", B1::kFrontSiCut};
+    regions_["strips"] = {"SiStrip", B1::kSiStripCut};
+    regions_["csi"] = {"CsI", B1::kCsICut};
+    regions_["world"] = {"DefaultRegionForTheWorld", B1::kWorldCut};
+    messenger_ = new DetectorMessenger(this);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  DetectorConstruction::~DetectorConstruction()
+  {
+    delete messenger_;
+    for (auto &entry : regions_)
+    {
+      delete entry.second.limits;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
   G4VPhysicalVolume *DetectorConstruction::Construct()
   {
     // Get nist material manager
@@ -108,6 +142,7 @@ namespace B1
     auto logicTarget = new G4LogicalVolume(tubs, target_mat, "Target");
     G4ThreeVector target_pos;
     new G4PVPlacement(nullptr, target_pos, logicTarget, "target", logicWorld, false, 0, checkOverlaps);
+    CreateRegion("target", logicTarget);
 
     /// Si strips
     G4Material *si_mat = nist->FindOrBuildMaterial("G4_Si");
@@ -143,6 +178,7 @@ namespace B1
     // Set siStip as scoring volume
     //
     fScoringVolume = siStripLogic;
+    CreateRegion("strips", siStripLogic);
 
     // front Si
     auto SiSolid = new G4Box("Si", 0.5 * B1::kSiSize, 0.5 * B1::kSiSize, 0.5 * B1::kFrontSiThickness);
@@ -152,6 +188,7 @@ namespace B1
     G4VisAttributes *SiAttributes = new G4VisAttributes();
     SiAttributes->SetColor(1, 0, 0);
     SiLogic->SetVisAttributes(SiAttributes);
+    CreateRegion("frontSi", SiLogic);
 
     /// CsI
     auto CsISolid = new G4Box("CsI", 0.5 * B1::kCsISize, 0.5 * B1::kCsISize, 0.5 * B1::kCsIThickness);
@@ -183,10 +220,158 @@ namespace B1
     // always return the physical World
     //
     new G4PVPlacement(&B1::kRotation, B1::kPosition, logicDet, "detector", logicWorld, false, 0);
+    CreateRegion("csi", CsILogic);
+
+    // the world region exists with the world volume
+    auto &world = regions_["world"];
+    world.region = G4RegionStore::GetInstance()->GetRegion(world.regionName, false);
+    ApplyRegionSettings(world);
 
     return physWorld;
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+  void DetectorConstruction::ConstructSDandField()
+  {
+    // fast simulation managers are thread-local, each worker attaches its
+    // own model; the region manager does not delete the models
+    if (TargetFastModel::IsEnabled())
+      new TargetFastModel("TargetFastModel", regions_["target"].region);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4String DetectorConstruction::RegionNames()
+  {
+    return "target frontSi strips csi world";
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorConstruction::SetRegionCut(const G4String &name, G4double cut)
+  {
+    auto it = regions_.find(name);
+    if (it == regions_.end())
+    {
+      G4cerr << "Unknown region " << name << ", expected one of: " << RegionNames() << G4endl;
+      return;
+    }
+    it->second.cut = cut;
+    // before the geometry is built the settings are applied by Construct
+    if (it->second.region)
+    {
+      ApplyRegionSettings(it->second);
+      G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorConstruction::SetRegionMaxStep(const G4String &name, G4double maxStep)
+  {
+    auto it = regions_.find(name);
+    if (it == regions_.end())
+    {
+      G4cerr << "Unknown region " << name << ", expected one of: " << RegionNames() << G4endl;
+      return;
+    }
+    if (maxStep > 0. && !EnableStepLimiter())
+      return;
+    it->second.maxStep = maxStep;
+    if (it->second.region)
+      ApplyRegionSettings(it->second);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool DetectorConstruction::EnableStepLimiter()
+  {
+    auto kernel = G4RunManagerKernel::GetRunManagerKernel();
+    auto physicsList = kernel ? dynamic_cast<G4VModularPhysicsList *>(kernel->GetPhysicsList()) : nullptr;
+    if (!physicsList)
+    {
+      G4cerr << "Step limits need a modular physics list" << G4endl;
+      return false;
+    }
+    if (physicsList->GetPhysics("stepLimiter"))
+      return true;
+    // the processes are constructed by /run/initialize
+    if (G4StateManager::GetStateManager()->GetCurrentState() != G4State_PreInit)
+    {
+      G4cerr << "The first step limit must be set before /run/initialize" << G4endl;
+      return false;
+    }
+    physicsList->RegisterPhysics(new G4StepLimiterPhysics());
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorConstruction::PrintRegions() const
+  {
+    G4cout << "Regions:" << G4endl;
+    for (const auto &entry : regions_)
+    {
+      const auto &settings = entry.second;
+      G4cout << "  " << entry.first << " (" << settings.regionName << "): cut " << G4BestUnit(settings.cut, "Length")
+             << ", max step ";
+      if (settings.maxStep > 0.)
+        G4cout << G4BestUnit(settings.maxStep, "Length") << G4endl;
+      else
+        G4cout << "none" << G4endl;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorConstruction::CreateRegion(const G4String &name, G4LogicalVolume *rootVolume)
+  {
+    auto &settings = regions_[name];
+    // a rebuilt geometry keeps its regions
+    if (!settings.region)
+      settings.region = new G4Region(settings.regionName);
+    settings.region->AddRootLogicalVolume(rootVolume);
+    ApplyRegionSettings(settings);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorConstruction::ApplyRegionSettings(RegionSettings &settings)
+  {
+    if (!settings.region)
+      return;
+
+    if (settings.regionName == "DefaultRegionForTheWorld")
+    {
+      // the cuts of the world region are the default cuts of the physics list
+      auto kernel = G4RunManagerKernel::GetRunManagerKernel();
+      if (kernel && kernel->GetPhysicsList())
+        kernel->GetPhysicsList()->SetDefaultCutValue(settings.cut);
+    }
+    else
+    {
+      G4ProductionCuts *cuts = settings.region->GetProductionCuts();
+      if (!cuts)
+      {
+        cuts = new G4ProductionCuts;
+        settings.region->SetProductionCuts(cuts);
+      }
+      cuts->SetProductionCut(settings.cut);
+    }
+
+    // regions without a step limit have no user limits to check
+    if (settings.maxStep <= 0.)
+    {
+      settings.region->SetUserLimits(nullptr);
+      return;
+    }
+    if (!settings.limits)
+      settings.limits = new G4UserLimits;
+    settings.limits->SetMaxAllowedStep(settings.maxStep);
+    settings.region->SetUserLimits(settings.limits);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 }
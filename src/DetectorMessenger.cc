@@ -0,0 +1,102 @@
+/// \file B1/src/DetectorMessenger.cc
+/// \brief Implementation of the B1::DetectorMessenger class
+
+#include "DetectorMessenger.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  DetectorMessenger::DetectorMessenger(DetectorConstruction *detector)
+      : detector_(detector)
+  {
+    directory_ = new G4UIdirectory("/octupole/");
+    directory_->SetGuidance("Octupole application commands.");
+    region_directory_ = new G4UIdirectory("/octupole/region/");
+    region_directory_->SetGuidance("Production cuts and step limits per detector region.");
+
+    set_cut_cmd_ = CreateRegionCommand("/octupole/region/setCut",
+                                       "Set the production cut of all particles in a region.");
+    set_max_step_cmd_ = CreateRegionCommand("/octupole/region/setMaxStep",
+                                            "Limit the step length in a region, 0 removes the limit."
+                                            " The first limit must be set before /run/initialize.");
+
+    print_cmd_ = new G4UIcmdWithoutParameter("/octupole/region/print", this);
+    print_cmd_->SetGuidance("Print the cuts and step limits of the regions.");
+    print_cmd_->SetToBeBroadcasted(false);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  DetectorMessenger::~DetectorMessenger()
+  {
+    delete print_cmd_;
+    delete set_max_step_cmd_;
+    delete set_cut_cmd_;
+    delete region_directory_;
+    delete directory_;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4UIcommand *DetectorMessenger::CreateRegionCommand(const G4String &path, const G4String &guidance)
+  {
+    auto command = new G4UIcommand(path.c_str(), this);
+    command->SetGuidance(guidance.c_str());
+
+    auto region = new G4UIparameter("region", 's', false);
+    region->SetParameterCandidates(DetectorConstruction::RegionNames().c_str());
+    command->SetParameter(region);
+
+    auto value = new G4UIparameter("value", 'd', false);
+    value->SetParameterRange("value>=0.");
+    command->SetParameter(value);
+
+    auto unit = new G4UIparameter("unit", 's', true);
+    unit->SetDefaultValue("mm");
+    unit->SetParameterCandidates(G4UIcommand::UnitsList("Length").c_str());
+    command->SetParameter(unit);
+
+    // regions only exist in the master
+    command->AvailableForStates(G4State_PreInit, G4State_Idle);
+    command->SetToBeBroadcasted(false);
+    return command;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void DetectorMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+  {
+    if (command == print_cmd_)
+    {
+      detector_->PrintRegions();
+      return;
+    }
+
+    std::istringstream iss(newValue);
+    G4String region, unit;
+    G4double value;
+    iss >> region >> value >> unit;
+    value *= G4UIcommand::ValueOf(unit.c_str());
+    if (command == set_cut_cmd_)
+    {
+      detector_->SetRegionCut(region, value);
+    }
+    else if (command == set_max_step_cmd_)
+    {
+      detector_->SetRegionMaxStep(region, value);
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -33,45 +33,84 @@
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 
+#include "EventSeeder.hh"
 #include "InitParticleEventInfo.hh"
+#include "PhaseProfiler.hh"
+#include "PrecisionTarget.hh"
+#include "Reconstruction.hh"
+#include "StepCensus.hh"
+#include "Telemetry.hh"
+#include "TruthRecorder.hh"
+
 namespace B1
 {
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  EventAction::EventAction(std::shared_ptr<RunAction> runAction)
+  EventAction::EventAction(RunAction *runAction)
       : runAction_(runAction)
   {
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  void EventAction::BeginOfEventAction(const G4Event *)
+  void EventAction::BeginOfEventAction(const G4Event *anEvent)
   {
+    OCTUPOLE_PROFILE_BEGIN(Phase::Event);
     frontSi_ = 0;
+    nSteps_ = 0;
+    if (StepCensus::IsEnabled())
+      StepCensus::Instance().BeginEvent();
+    if (TruthRecorder::IsEnabled())
+      TruthRecorder::Instance().BeginEvent(EventSeeder::GlobalEventId(anEvent));
     SiMap_.clear();
     CsIMap_.clear();
+    start_ = std::chrono::steady_clock::now();
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
   void EventAction::EndOfEventAction(const G4Event *anEvent)
   {
+    OCTUPOLE_PROFILE_END(Phase::Event);
+    // skipped by the generator, e.g. completed before a resume
+    if (anEvent->IsAborted())
+      return;
+    OCTUPOLE_PROFILE_SCOPE(Phase::EventAccumulation);
+    const int64_t eventId = EventSeeder::GlobalEventId(anEvent);
+    runAction_->SetEventId(eventId);
     auto info = (InitParticleEventInfo *)anEvent->GetUserInformation();
     runAction_->AddEventInfo(info->GetProtonEnergy(), info->GetThetaLab(), info->GetPhiLab());
-    for (const auto &si : SiMap_)
+    if (Reconstruction::RawHits())
     {
-      runAction_->AddEdep("Si", si.second, si.first);
+      for (const auto &si : SiMap_)
+      {
+        runAction_->AddEdep("Si", si.second, si.first);
+      }
+      for (const auto &csi : CsIMap_)
+      {
+        runAction_->AddEdep("CsI", csi.second, csi.first);
+      }
+      if (frontSi_ > 0)
+        runAction_->AddEdep("front", frontSi_, 0);
     }
-    for (const auto &csi : CsIMap_)
+    if (Reconstruction::IsEnabled())
     {
-      runAction_->AddEdep("CsI", csi.second, csi.first);
+      OCTUPOLE_PROFILE_SCOPE(Phase::Reconstruction);
+      Reconstruction::Reconstruct(SiMap_, frontSi_, CsIMap_, recoHits_);
+      for (const auto &hit : recoHits_)
+        runAction_->AddRecoHit(hit);
     }
-    if (frontSi_ > 0)
-      runAction_->AddEdep("front", frontSi_, 0);
+    if (PrecisionTarget::IsEnabled())
+      PrecisionTarget::AddEvent(PrecisionTarget::Selects(SiMap_, frontSi_, CsIMap_));
     // delete info;
     //  accumulate statistics in run action
+    runAction_->AddSteps(nSteps_);
+    runAction_->AddEventTime(std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start_).count());
     runAction_->IncrementEvent();
+    runAction_->EventDone(eventId);
+    if (Telemetry::IsEnabled())
+      runAction_->PublishTelemetry();
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,65 @@
+/// \file B1/src/EventBatching.cc
+/// \brief Implementation of the B1::EventBatching class
+
+#include "EventBatching.hh"
+
+#include "G4MTRunManager.hh"
+#include "G4TaskRunManager.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+  G4int EventBatching::fixed_batch_ = 0;
+  G4double EventBatching::event_cost_ = 0.;
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4int EventBatching::BatchSize(G4int nEvents, G4int nThreads, G4double eventCost)
+  {
+    const G4int target = static_cast<G4int>(std::lround(kTargetBatchSeconds / eventCost));
+    const G4int limit = nEvents / (std::max(nThreads, 1) * kMinBatchesPerThread);
+    return std::max(std::min(target, limit), 1);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void EventBatching::BeginRun(G4int nEvents)
+  {
+    auto *runManager = G4MTRunManager::GetMasterRunManager();
+    if (!runManager || nEvents <= 0)
+      return;
+
+    G4int batch = fixed_batch_;
+    if (batch <= 0 && event_cost_ > 0.)
+      batch = BatchSize(nEvents, runManager->GetNumberOfThreads(), event_cost_);
+    // 0 restores the defaults of the run manager
+    runManager->SetEventModulo(std::max(batch, 0));
+    auto *taskRunManager = dynamic_cast<G4TaskRunManager *>(runManager);
+    if (taskRunManager)
+      taskRunManager->SetGrainsize(batch > 0 ? (nEvents + batch - 1) / batch : 0);
+
+    if (batch > 0)
+    {
+      G4cout << "Event batching: " << batch << " events per batch";
+      if (taskRunManager)
+        G4cout << " in " << (nEvents + batch - 1) / batch << " tasks";
+      if (fixed_batch_ <= 0)
+        G4cout << " for " << event_cost_ * 1e3 << " ms per event";
+      G4cout << G4endl;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void EventBatching::EndRun(G4int nEvents, G4double eventSeconds)
+  {
+    if (nEvents > 0 && eventSeconds > 0.)
+      event_cost_ = eventSeconds / nEvents;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,94 @@
+/// \file B1/src/EventSeeder.cc
+/// \brief Implementation of the B1::EventSeeder class
+
+#include "EventSeeder.hh"
+#include "Sharding.hh"
+
+#include "G4Event.hh"
+#include "Randomize.hh"
+
+#include <sstream>
+
+namespace B1
+{
+
+  uint64_t EventSeeder::base_seed_ = 0;
+  uint64_t EventSeeder::job_seed_ = 0;
+  G4bool EventSeeder::job_seed_drawn_ = false;
+  std::string EventSeeder::seed_status_;
+  std::string EventSeeder::end_status_;
+
+  namespace
+  {
+    /// SplitMix64 step, a bijective mix with good avalanche
+    uint64_t SplitMix64(uint64_t &state)
+    {
+      uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+    }
+
+    /// Full state of the engine of the calling thread
+    std::string EngineStatus()
+    {
+      std::ostringstream oss;
+      G4Random::getTheEngine()->put(oss);
+      return oss.str();
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void EventSeeder::BeginRun(G4int runId)
+  {
+    // the engine state advances with the events of the previous runs, whose
+    // number differs per shard: draw once from the engine as seeded, and
+    // again only if it was reseeded since the end of the previous run
+    const std::string status = EngineStatus();
+    if (!job_seed_drawn_ || status != end_status_)
+    {
+      auto *engine = G4Random::getTheEngine();
+      const auto high = static_cast<uint64_t>(engine->flat() * 4294967296.);
+      const auto low = static_cast<uint64_t>(engine->flat() * 4294967296.);
+      job_seed_ = (high << 32) | low;
+      seed_status_ = status;
+      job_seed_drawn_ = true;
+    }
+    uint64_t state = job_seed_ ^ static_cast<uint64_t>(runId) * 0xD1B54A32D192ED03ull;
+    base_seed_ = SplitMix64(state);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void EventSeeder::EndRun()
+  {
+    end_status_ = EngineStatus();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  int64_t EventSeeder::GlobalEventId(const G4Event *event)
+  {
+    return Sharding::GetEventIdOffset() + event->GetEventID();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void EventSeeder::SeedEvent(int64_t globalEventId)
+  {
+    uint64_t state = base_seed_ ^ static_cast<uint64_t>(globalEventId) * 0xD1B54A32D192ED03ull;
+    // four non-zero 32-bit seeds, the list is terminated by 0
+    long seeds[5] = {0, 0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i)
+    {
+      seeds[i] = static_cast<long>(SplitMix64(state) & 0x7FFFFFFF);
+      if (seeds[i] == 0)
+        seeds[i] = 1;
+    }
+    G4Random::setTheSeeds(seeds);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,322 @@
+/// \file B1/src/IpcStreamSink.cc
+/// \brief Implementation of the B1::IpcStreamSink class
+
+#include "IpcStreamSink.hh"
+
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace B1
+{
+
+  G4bool IpcStreamSink::enabled_ = false;
+  G4int IpcStreamSink::batch_events_ = 0;
+
+  namespace
+  {
+    enum class Policy
+    {
+      Drop,
+      DropOldest,
+      Block
+    };
+
+    /// Queue, connection and writer thread of one table
+    struct Channel
+    {
+      std::string name;
+      std::string path;
+      std::shared_ptr<arrow::Schema> schema;
+
+      std::mutex mutex;
+      std::condition_variable queued;
+      std::condition_variable dequeued;
+      std::deque<std::shared_ptr<arrow::RecordBatch>> queue;
+      bool connected = false;
+      bool stop = false;
+      uint64_t sent = 0;
+      uint64_t dropped = 0;
+
+      std::thread thread;
+      std::shared_ptr<arrow::io::FileOutputStream> stream;
+      std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+    };
+
+    G4bool useSocket = false;
+    Policy policy = Policy::Drop;
+    std::size_t queueBatches = 64;
+    Channel channels[2];
+
+    void Disconnect(Channel &channel);
+
+    /// Opens the endpoint and starts a stream with the schema; false if no
+    /// consumer is there yet
+    bool Connect(Channel &channel)
+    {
+      int fd = -1;
+      if (useSocket)
+      {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, channel.path.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+          close(fd);
+          fd = -1;
+        }
+      }
+      else
+      {
+        // fails with ENXIO until a reader opened the pipe
+        fd = open(channel.path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0)
+          fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+      }
+      if (fd < 0)
+        return false;
+
+      // the stream owns the descriptor from here on
+      auto stream = arrow::io::FileOutputStream::Open(fd);
+      if (!stream.ok())
+      {
+        close(fd);
+        return false;
+      }
+      channel.stream = *stream;
+      auto writer = arrow::ipc::MakeStreamWriter(channel.stream, channel.schema);
+      if (!writer.ok())
+      {
+        Disconnect(channel);
+        return false;
+      }
+      channel.writer = *writer;
+      return true;
+    }
+
+    void Disconnect(Channel &channel)
+    {
+      if (channel.writer)
+        channel.writer->Close();
+      channel.writer.reset();
+      if (channel.stream)
+        channel.stream->Close();
+      channel.stream.reset();
+    }
+
+    void Run(Channel &channel)
+    {
+      std::unique_lock<std::mutex> lock(channel.mutex);
+      while (true)
+      {
+        if (!channel.connected)
+        {
+          // a stopping job does not wait for a consumer
+          if (channel.stop)
+            break;
+          lock.unlock();
+          const bool connected = Connect(channel);
+          lock.lock();
+          channel.connected = connected;
+          if (!connected)
+          {
+            channel.dropped += channel.queue.size();
+            channel.queue.clear();
+            channel.dequeued.notify_all();
+            channel.queued.wait_for(lock, std::chrono::seconds(1), [&] { return channel.stop; });
+            continue;
+          }
+          // not a Geant4 thread, hence no G4cout
+          std::cout << "Streaming " << channel.name << " to " << channel.path << std::endl;
+        }
+
+        channel.queued.wait(lock, [&] { return channel.stop || !channel.queue.empty(); });
+        if (channel.queue.empty())
+          break;
+        auto batch = std::move(channel.queue.front());
+        channel.queue.pop_front();
+        channel.dequeued.notify_all();
+
+        lock.unlock();
+        const bool ok = channel.writer->WriteRecordBatch(*batch).ok();
+        lock.lock();
+        if (ok)
+        {
+          ++channel.sent;
+        }
+        else
+        {
+          // the consumer went away, the next one gets a new stream
+          ++channel.dropped;
+          channel.connected = false;
+          lock.unlock();
+          Disconnect(channel);
+          lock.lock();
+        }
+      }
+      // the batches hold memory of the worker pools
+      channel.dropped += channel.queue.size();
+      channel.queue.clear();
+      lock.unlock();
+      Disconnect(channel);
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool IpcStreamSink::Configure(const std::string &destination, const std::string &policyName,
+                                  G4int nQueueBatches, G4int batchEvents, std::shared_ptr<arrow::Schema> eDepSchema,
+                                  std::shared_ptr<arrow::Schema> evtInfoSchema)
+  {
+    if (destination.empty())
+      return true;
+
+    std::string path;
+    if (destination.rfind("unix:", 0) == 0)
+    {
+      useSocket = true;
+      path = destination.substr(5);
+    }
+    else if (destination.rfind("fifo:", 0) == 0)
+    {
+      useSocket = false;
+      path = destination.substr(5);
+    }
+    if (path.empty())
+    {
+      G4cerr << "Invalid stream " << destination << ", expected fifo:<path> or unix:<path>" << G4endl;
+      return false;
+    }
+
+    if (policyName == "drop")
+      policy = Policy::Drop;
+    else if (policyName == "oldest")
+      policy = Policy::DropOldest;
+    else if (policyName == "block")
+      policy = Policy::Block;
+    else
+    {
+      G4cerr << "Invalid stream policy " << policyName << ", expected drop, oldest or block" << G4endl;
+      return false;
+    }
+    queueBatches = std::max(nQueueBatches, 1);
+    batch_events_ = std::max(batchEvents, 1);
+
+    // a vanished consumer must not kill the job
+    signal(SIGPIPE, SIG_IGN);
+
+    const std::shared_ptr<arrow::Schema> schemas[2] = {eDepSchema, evtInfoSchema};
+    const char *names[2] = {"eDep", "evtInfo"};
+    for (int i = 0; i < 2; ++i)
+    {
+      auto &channel = channels[i];
+      channel.name = names[i];
+      channel.path = path + "." + names[i];
+      channel.schema = schemas[i];
+      if (!useSocket && mkfifo(channel.path.c_str(), 0644) != 0 && errno != EEXIST)
+      {
+        G4cerr << "Cannot create the pipe " << channel.path << ": " << std::strerror(errno) << G4endl;
+        return false;
+      }
+    }
+    for (auto &channel : channels)
+      channel.thread = std::thread(Run, std::ref(channel));
+    enabled_ = true;
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void IpcStreamSink::Publish(Table table, std::shared_ptr<arrow::RecordBatch> batch)
+  {
+    auto &channel = channels[static_cast<int>(table)];
+    std::unique_lock<std::mutex> lock(channel.mutex);
+    if (!channel.connected)
+    {
+      ++channel.dropped;
+      return;
+    }
+    if (channel.queue.size() >= queueBatches)
+    {
+      if (policy == Policy::Drop)
+      {
+        ++channel.dropped;
+        return;
+      }
+      if (policy == Policy::DropOldest)
+      {
+        ++channel.dropped;
+        channel.queue.pop_front();
+      }
+      else
+      {
+        channel.dequeued.wait(lock, [&] { return channel.queue.size() < queueBatches || !channel.connected; });
+        if (!channel.connected)
+        {
+          ++channel.dropped;
+          return;
+        }
+      }
+    }
+    channel.queue.push_back(std::move(batch));
+    channel.queued.notify_one();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void IpcStreamSink::PrintRunSummary(std::ostream &os)
+  {
+    if (!enabled_)
+      return;
+    for (auto &channel : channels)
+    {
+      std::lock_guard<std::mutex> lock(channel.mutex);
+      os << " Stream " << channel.name << ": " << channel.sent << " batches sent, " << channel.dropped
+         << " dropped, " << channel.queue.size() << " queued" << std::endl;
+      channel.sent = 0;
+      channel.dropped = 0;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void IpcStreamSink::Shutdown()
+  {
+    if (!enabled_)
+      return;
+    for (auto &channel : channels)
+    {
+      {
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        channel.stop = true;
+      }
+      channel.queued.notify_all();
+    }
+    for (auto &channel : channels)
+    {
+      if (channel.thread.joinable())
+        channel.thread.join();
+    }
+    enabled_ = false;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,93 @@
+/// \file B1/src/LeanHadronPhysics.cc
+/// \brief Implementation of the B1::LeanHadronPhysics class
+
+#include "LeanHadronPhysics.hh"
+
+#include "G4Proton.hh"
+#include "G4Neutron.hh"
+#include "G4BaryonConstructor.hh"
+#include "G4MesonConstructor.hh"
+#include "G4IonConstructor.hh"
+#include "G4PhysicsListHelper.hh"
+#include "G4HadronElasticProcess.hh"
+#include "G4HadronInelasticProcess.hh"
+#include "G4NeutronCaptureProcess.hh"
+#include "G4HadronElastic.hh"
+#include "G4BinaryCascade.hh"
+#include "G4NeutronRadCapture.hh"
+#include "G4BGGNucleonElasticXS.hh"
+#include "G4BGGNucleonInelasticXS.hh"
+#include "G4NeutronElasticXS.hh"
+#include "G4NeutronInelasticXS.hh"
+#include "G4NeutronCaptureXS.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  LeanHadronPhysics::LeanHadronPhysics(G4int verbose)
+      : G4VPhysicsConstructor("LeanHadron")
+  {
+    SetVerboseLevel(verbose);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void LeanHadronPhysics::ConstructParticle()
+  {
+    // the cascade and the de-excitation produce pions and light ions
+    G4BaryonConstructor baryons;
+    baryons.ConstructParticle();
+    G4MesonConstructor mesons;
+    mesons.ConstructParticle();
+    G4IonConstructor ions;
+    ions.ConstructParticle();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void LeanHadronPhysics::ConstructProcess()
+  {
+    G4PhysicsListHelper *helper = G4PhysicsListHelper::GetPhysicsListHelper();
+    G4ParticleDefinition *proton = G4Proton::Proton();
+    G4ParticleDefinition *neutron = G4Neutron::Neutron();
+
+    // models are shared between the processes
+    auto elasticModel = new G4HadronElastic();
+    auto cascade = new G4BinaryCascade();
+    cascade->SetMinEnergy(0.);
+    cascade->SetMaxEnergy(10. * GeV);
+
+    // proton
+    auto protonElastic = new G4HadronElasticProcess();
+    protonElastic->AddDataSet(new G4BGGNucleonElasticXS(proton));
+    protonElastic->RegisterMe(elasticModel);
+    helper->RegisterProcess(protonElastic, proton);
+
+    auto protonInelastic = new G4HadronInelasticProcess("protonInelastic", proton);
+    protonInelastic->AddDataSet(new G4BGGNucleonInelasticXS(proton));
+    protonInelastic->RegisterMe(cascade);
+    helper->RegisterProcess(protonInelastic, proton);
+
+    // neutron
+    auto neutronElastic = new G4HadronElasticProcess();
+    neutronElastic->AddDataSet(new G4NeutronElasticXS());
+    neutronElastic->RegisterMe(elasticModel);
+    helper->RegisterProcess(neutronElastic, neutron);
+
+    auto neutronInelastic = new G4HadronInelasticProcess("neutronInelastic", neutron);
+    neutronInelastic->AddDataSet(new G4NeutronInelasticXS());
+    neutronInelastic->RegisterMe(cascade);
+    helper->RegisterProcess(neutronInelastic, neutron);
+
+    auto neutronCapture = new G4NeutronCaptureProcess();
+    neutronCapture->AddDataSet(new G4NeutronCaptureXS());
+    neutronCapture->RegisterMe(new G4NeutronRadCapture());
+    helper->RegisterProcess(neutronCapture, neutron);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
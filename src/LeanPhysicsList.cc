@@ -0,0 +1,44 @@
+/// \file B1/src/LeanPhysicsList.cc
+/// \brief Implementation of the B1::LeanPhysicsList class
+
+#include "LeanPhysicsList.hh"
+#include "LeanHadronPhysics.hh"
+
+#include "G4EmStandardPhysics_option3.hh"
+#include "G4EmParameters.hh"
+#include "G4DecayPhysics.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  LeanPhysicsList::LeanPhysicsList()
+  {
+    const G4int verbose = 1;
+    SetVerboseLevel(verbose);
+    SetDefaultCutValue(0.7 * mm);
+
+    // EM physics: option 3 gives accurate proton stopping powers and straggling.
+    // The tables only need to cover the experiment (protons below 300 MeV and
+    // their secondaries), and fluorescence/Auger electrons are far below the
+    // detector thresholds.
+    RegisterPhysics(new G4EmStandardPhysics_option3(verbose));
+    G4EmParameters *emParameters = G4EmParameters::Instance();
+    emParameters->SetMaxEnergy(1. * GeV);
+    emParameters->SetFluo(false);
+    emParameters->SetAuger(false);
+    emParameters->SetPixe(false);
+    emParameters->SetLowestElectronEnergy(10. * keV);
+
+    // Decays construct the particles used by the hadronic constructor
+    RegisterPhysics(new G4DecayPhysics(verbose));
+
+    // Proton and neutron hadronic interactions
+    RegisterPhysics(new LeanHadronPhysics(verbose));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
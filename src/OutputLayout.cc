@@ -0,0 +1,154 @@
+/// \file B1/src/OutputLayout.cc
+/// \brief Implementation of the B1::OutputLayout class
+
+#include "OutputLayout.hh"
+
+#include <arrow/compute/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+
+namespace B1
+{
+
+  OutputLayout::Order OutputLayout::order_ = OutputLayout::Order::None;
+  int64_t OutputLayout::row_group_rows_ = OutputLayout::kDefaultRowGroupRows;
+  G4bool OutputLayout::bloom_filters_ = false;
+
+  namespace
+  {
+    // key columns of all tables, in sort priority; each table sorts by the
+    // ones it has
+    const std::vector<std::string> eventKeys = {"eventId", "detName", "copyId", "csiId", "firstStrip", "trackId"};
+    const std::vector<std::string> detectorKeys = {"detName", "copyId", "csiId", "eventId", "firstStrip", "trackId"};
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool OutputLayout::Configure(const std::string &order, int64_t rowGroupRows, G4bool bloomFilters)
+  {
+    if (order.empty() || order == "none")
+      order_ = Order::None;
+    else if (order == "event")
+      order_ = Order::Event;
+    else if (order == "detector")
+      order_ = Order::Detector;
+    else
+    {
+      G4cerr << "Invalid sort order " << order << ", expected none, event or detector" << G4endl;
+      return false;
+    }
+    if (order_ == Order::None)
+      return true;
+
+#if ARROW_VERSION_MAJOR >= 21
+    // the sort kernels live in the separate compute library since Arrow 21
+    const auto status = arrow::compute::Initialize();
+    if (!status.ok())
+    {
+      G4cerr << "Cannot initialize the Arrow compute functions: " << status.ToString() << G4endl;
+      return false;
+    }
+#endif
+
+    row_group_rows_ = rowGroupRows > 0 ? rowGroupRows : kDefaultRowGroupRows;
+    bloom_filters_ = bloomFilters;
+#ifndef OCTUPOLE_PARQUET_BLOOM_FILTER
+    if (bloomFilters)
+    {
+      G4cerr << "Warning: the Parquet library cannot write bloom filters, --bloom is ignored" << G4endl;
+      bloom_filters_ = false;
+    }
+#endif
+    G4cout << "Sorting the output by " << order << " in row groups of " << row_group_rows_ << " rows"
+           << (bloom_filters_ ? ", with bloom filters on eventId" : "") << G4endl;
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::vector<std::string> OutputLayout::SortKeys(const arrow::Schema &schema)
+  {
+    std::vector<std::string> keys;
+    if (order_ == Order::None)
+      return keys;
+    for (const auto &key : order_ == Order::Event ? eventKeys : detectorKeys)
+    {
+      if (schema.GetFieldIndex(key) >= 0)
+        keys.emplace_back(key);
+    }
+    return keys;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<parquet::WriterProperties> OutputLayout::WriterProperties(const arrow::Schema &schema)
+  {
+    if (order_ == Order::None)
+      return parquet::default_writer_properties();
+
+    parquet::WriterProperties::Builder builder;
+    builder.max_row_group_length(row_group_rows_)->enable_statistics()->enable_write_page_index();
+
+    // every column of the output tables is a single leaf, so field and
+    // column indexes agree
+    std::vector<parquet::SortingColumn> sortingColumns;
+    for (const auto &key : SortKeys(schema))
+    {
+      parquet::SortingColumn column;
+      column.column_idx = schema.GetFieldIndex(key);
+      column.descending = false;
+      column.nulls_first = false;
+      sortingColumns.emplace_back(column);
+    }
+    builder.set_sorting_columns(sortingColumns);
+
+#ifdef OCTUPOLE_PARQUET_BLOOM_FILTER
+    if (bloom_filters_ && schema.GetFieldIndex("eventId") >= 0)
+    {
+      parquet::BloomFilterOptions options;
+      // at most one distinct event per row
+      options.ndv = static_cast<int32_t>(row_group_rows_);
+      options.fpp = kBloomFilterFpp;
+      builder.enable_bloom_filter("eventId", options);
+    }
+#endif
+    return builder.build();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void OutputLayout::Write(std::shared_ptr<arrow::Table> table, const std::string &file, arrow::MemoryPool *pool)
+  {
+    std::shared_ptr<arrow::io::FileOutputStream> outfile;
+    PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(file));
+    if (order_ == Order::None)
+    {
+      PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, pool, outfile));
+      return;
+    }
+
+    const auto keys = SortKeys(*table->schema());
+    if (!keys.empty() && table->num_rows() > 1)
+    {
+      std::vector<arrow::compute::SortKey> sortKeys;
+      for (const auto &key : keys)
+        sortKeys.emplace_back(key);
+      arrow::compute::ExecContext context(pool);
+      // stable, rows with equal keys keep the order of the worker
+      std::shared_ptr<arrow::Array> indices;
+      PARQUET_ASSIGN_OR_THROW(indices,
+                              arrow::compute::SortIndices(arrow::Datum(table), arrow::compute::SortOptions(sortKeys),
+                                                          &context));
+      arrow::Datum sorted;
+      PARQUET_ASSIGN_OR_THROW(sorted, arrow::compute::Take(arrow::Datum(table), arrow::Datum(indices),
+                                                           arrow::compute::TakeOptions::Defaults(), &context));
+      table = sorted.table();
+    }
+    PARQUET_THROW_NOT_OK(
+        parquet::arrow::WriteTable(*table, pool, outfile, row_group_rows_, WriterProperties(*table->schema())));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,110 @@
+/// \file B1/src/PhaseProfiler.cc
+/// \brief Implementation of the B1::PhaseProfiler class
+
+#include "PhaseProfiler.hh"
+
+#include "G4AutoLock.hh"
+
+#include <fstream>
+#include <iomanip>
+
+namespace B1
+{
+
+  namespace
+  {
+    G4Mutex masterMutex = G4MUTEX_INITIALIZER;
+    std::array<uint64_t, PhaseProfiler::kNPhases> masterTicks{};
+    std::array<uint64_t, PhaseProfiler::kNPhases> masterCalls{};
+    // ticks since ResetMaster()
+    TickCalibration calibration;
+
+    const char *kPhaseNames[PhaseProfiler::kNPhases] = {"event",          "stepping",         "eventAccumulation",
+                                                         "arrowAppendHit", "arrowAppendEvent", "parquetWrite",
+                                                         "reconstruction"};
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  PhaseProfiler &PhaseProfiler::Instance()
+  {
+    static thread_local PhaseProfiler profiler;
+    return profiler;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhaseProfiler::MergeToMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    for (int i = 0; i < kNPhases; ++i)
+    {
+      masterTicks[i] += ticks_[i];
+      masterCalls[i] += calls_[i];
+    }
+    ticks_.fill(0);
+    calls_.fill(0);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhaseProfiler::ResetMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    masterTicks.fill(0);
+    masterCalls.fill(0);
+    calibration.Start();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhaseProfiler::PrintMaster(std::ostream &os)
+  {
+    G4AutoLock lock(&masterMutex);
+    const double ticksPerSecond = calibration.TicksPerSecond();
+    const uint64_t eventTicks = masterTicks[static_cast<int>(Phase::Event)];
+
+    os << " Phase profile (summed over threads):" << std::endl;
+    os << "  " << std::setw(18) << std::left << "phase" << std::right << std::setw(12) << "calls"
+       << std::setw(14) << "time[s]" << std::setw(14) << "ns/call" << std::setw(10) << "%event" << std::endl;
+    auto printLine = [&](const char *name, uint64_t calls, uint64_t ticks) {
+      const double seconds = ticks / ticksPerSecond;
+      os << "  " << std::setw(18) << std::left << name << std::right << std::setw(12) << calls << std::setw(14)
+         << std::setprecision(4) << seconds << std::setw(14) << std::setprecision(4)
+         << (calls ? 1e9 * seconds / calls : 0.) << std::setw(10) << std::setprecision(3)
+         << (eventTicks ? 100. * ticks / eventTicks : 0.) << std::endl;
+    };
+    for (int i = 0; i < kNPhases; ++i)
+    {
+      printLine(kPhaseNames[i], masterCalls[i], masterTicks[i]);
+    }
+    // what the event loop spends outside the user actions
+    const uint64_t steppingTicks = masterTicks[static_cast<int>(Phase::Stepping)];
+    printLine("transport", masterCalls[static_cast<int>(Phase::Event)],
+              eventTicks > steppingTicks ? eventTicks - steppingTicks : 0);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhaseProfiler::WriteMaster(const std::string &fname)
+  {
+    std::ofstream fout(fname);
+    if (!fout)
+    {
+      G4cerr << "Cannot write " << fname << G4endl;
+      return;
+    }
+    G4AutoLock lock(&masterMutex);
+    const double ticksPerSecond = calibration.TicksPerSecond();
+    fout << "# phase calls ticks seconds" << std::endl;
+    fout << "# ticksPerSecond " << std::setprecision(10) << ticksPerSecond << std::endl;
+    for (int i = 0; i < kNPhases; ++i)
+    {
+      fout << kPhaseNames[i] << " " << masterCalls[i] << " " << masterTicks[i] << " "
+           << masterTicks[i] / ticksPerSecond << std::endl;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
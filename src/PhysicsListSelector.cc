@@ -0,0 +1,65 @@
+/// \file B1/src/PhysicsListSelector.cc
+/// \brief Runtime selection of the physics list
+
+#include "PhysicsListSelector.hh"
+#include "LeanPhysicsList.hh"
+#include "TargetFastModel.hh"
+
+#include "G4FastSimulationPhysics.hh"
+#include "G4PhysListFactory.hh"
+#include "G4VModularPhysicsList.hh"
+
+#include <cstdlib>
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4String SelectPhysicsListName(const G4String &requested)
+  {
+    if (!requested.empty())
+      return requested;
+    const char *env = std::getenv("OCTUPOLE_PHYSICS_LIST");
+    if (env && *env)
+      return env;
+    return "QBBC";
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4VModularPhysicsList *CreatePhysicsList(const G4String &name)
+  {
+    G4VModularPhysicsList *physicsList = nullptr;
+    if (name == "lean")
+    {
+      physicsList = new LeanPhysicsList;
+    }
+    else
+    {
+      G4PhysListFactory factory;
+      if (!factory.IsReferencePhysList(name))
+      {
+        G4cerr << "Unknown physics list: " << name << ", available: lean";
+        for (const auto &available : factory.AvailablePhysLists())
+        {
+          G4cerr << " " << available;
+        }
+        G4cerr << G4endl;
+        return nullptr;
+      }
+      physicsList = factory.GetReferencePhysList(name);
+    }
+    // Target shortcut, see TargetFastModel
+    if (TargetFastModel::IsEnabled())
+    {
+      auto fastSimulation = new G4FastSimulationPhysics();
+      fastSimulation->ActivateFastSimulation("proton");
+      physicsList->RegisterPhysics(fastSimulation);
+    }
+    return physicsList;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
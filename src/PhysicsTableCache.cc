@@ -0,0 +1,239 @@
+/// \file B1/src/PhysicsTableCache.cc
+/// \brief Implementation of the B1::PhysicsTableCache class
+
+#include "PhysicsTableCache.hh"
+
+#include "G4StateManager.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "G4EmParameters.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4IonisParamMat.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Version.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+#include <unistd.h>
+
+namespace B1
+{
+
+  namespace
+  {
+    const char *kKeyFileName = "cacheKey.txt";
+
+    std::string HashKey(const std::string &key)
+    {
+      // 64-bit FNV-1a, only used to name the cache entry; the full key is
+      // stored next to the tables and compared before retrieving them
+      u_int64_t hash = 14695981039346656037ULL;
+      for (const unsigned char c : key)
+      {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+      }
+      std::ostringstream oss;
+      oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+      return oss.str();
+    }
+
+    double Seconds(std::chrono::steady_clock::duration d)
+    {
+      return std::chrono::duration<double>(d).count();
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  PhysicsTableCache::PhysicsTableCache(G4VUserPhysicsList *physicsList, const std::string &cacheDir)
+      : physicsList_(physicsList), cache_dir_(cacheDir), launch_time_(std::chrono::steady_clock::now())
+  {
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string PhysicsTableCache::DefaultDirectory()
+  {
+    const char *env = std::getenv("OCTUPOLE_PHYSICS_CACHE");
+    if (!env)
+      return "work/physicsCache";
+    const std::string dir(env);
+    if (dir == "none")
+      return "";
+    return dir;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool PhysicsTableCache::Notify(G4ApplicationState requestedState)
+  {
+    // The state manager calls us before switching, so the current state is
+    // still the one we are leaving. Idle -> Init is the start of the run
+    // initialization, in which the physics tables are built, and Init -> Idle
+    // is its end. The transitions of /run/initialize start from PreInit.
+    const G4ApplicationState currentState = G4StateManager::GetStateManager()->GetCurrentState();
+    if (currentState == G4State_Idle && requestedState == G4State_Init && !prepared_)
+    {
+      PrepareTables();
+    }
+    else if (currentState == G4State_Init && requestedState == G4State_Idle && prepared_ && !reported_)
+    {
+      TablesReady();
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhysicsTableCache::PrepareTables()
+  {
+    prepared_ = true;
+    build_start_ = std::chrono::steady_clock::now();
+    if (cache_dir_.empty())
+      return;
+
+    key_ = ComputeKey();
+    entry_dir_ = cache_dir_ + "/" + HashKey(key_);
+
+    std::ifstream fin(entry_dir_ + "/" + kKeyFileName);
+    if (!fin)
+      return;
+    std::stringstream stored;
+    stored << fin.rdbuf();
+    if (stored.str() != key_)
+    {
+      G4cout << "PhysicsTableCache: key mismatch in " << entry_dir_ << ", rebuilding physics tables" << G4endl;
+      return;
+    }
+    physicsList_->SetPhysicsTableRetrieved(entry_dir_);
+    retrieved_ = true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PhysicsTableCache::TablesReady()
+  {
+    reported_ = true;
+    const auto now = std::chrono::steady_clock::now();
+    G4String status = "cache disabled";
+    if (retrieved_ && physicsList_->IsPhysicsTableRetrieved())
+    {
+      status = "retrieved from " + entry_dir_;
+    }
+    else if (retrieved_)
+    {
+      // Geant4 fell back to building the tables, replace the stale entry
+      std::error_code ec;
+      std::filesystem::remove_all(entry_dir_, ec);
+      retrieved_ = false;
+      status = StoreTables(key_) ? "rebuilt and stored to " + entry_dir_ : "rebuilt, storing to " + entry_dir_ + " failed";
+    }
+    else if (!cache_dir_.empty())
+    {
+      status = StoreTables(key_) ? "built and stored to " + entry_dir_ : "built, storing to " + entry_dir_ + " failed";
+    }
+    G4cout << G4endl
+           << "PhysicsTableCache: physics tables " << status << G4endl
+           << "PhysicsTableCache: table preparation " << Seconds(now - build_start_) << " s, "
+           << "startup " << Seconds(now - launch_time_) << " s" << G4endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  bool PhysicsTableCache::StoreTables(const std::string &key) const
+  {
+    // Store into a private directory first and rename it into place, so that
+    // concurrent jobs sharing the cache never see a half written entry
+    namespace fs = std::filesystem;
+    const fs::path tmpDir = entry_dir_ + ".tmp" + std::to_string(::getpid());
+    std::error_code ec;
+    fs::create_directories(tmpDir, ec);
+    if (ec)
+      return false;
+    if (!physicsList_->StorePhysicsTable(tmpDir.string()))
+    {
+      fs::remove_all(tmpDir, ec);
+      return false;
+    }
+    {
+      std::ofstream fout(tmpDir / kKeyFileName);
+      fout << key;
+    }
+    fs::rename(tmpDir, entry_dir_, ec);
+    if (ec)
+    {
+      // another job stored the same entry in the meantime
+      fs::remove_all(tmpDir, ec);
+      return fs::exists(fs::path(entry_dir_) / kKeyFileName);
+    }
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string PhysicsTableCache::ComputeKey() const
+  {
+    std::ostringstream oss;
+    oss << std::setprecision(12);
+    oss << "geant4 " << G4VERSION_NUMBER << "\n";
+
+    // Physics list and its constructors
+    oss << "physicsList " << typeid(*physicsList_).name() << "\n";
+    if (auto modular = dynamic_cast<const G4VModularPhysicsList *>(physicsList_))
+    {
+      for (G4int i = 0; auto physics = modular->GetPhysics(i); ++i)
+      {
+        oss << "  " << physics->GetPhysicsName() << " " << physics->GetPhysicsType() << "\n";
+      }
+    }
+    G4EmParameters::Instance()->StreamInfo(oss);
+
+    // Materials
+    for (const auto material : *G4Material::GetMaterialTable())
+    {
+      oss << "material " << material->GetName()
+          << " " << material->GetDensity() / (g / cm3)
+          << " " << material->GetState()
+          << " " << material->GetTemperature() / kelvin
+          << " " << material->GetPressure() / atmosphere
+          << " " << material->GetIonisation()->GetMeanExcitationEnergy() / eV << "\n";
+      const G4double *fractions = material->GetFractionVector();
+      for (size_t i = 0; i < material->GetNumberOfElements(); ++i)
+      {
+        const G4Element *element = material->GetElement(i);
+        oss << "  " << element->GetZ() << " " << element->GetA() / (g / mole) << " " << fractions[i] << "\n";
+      }
+    }
+
+    // Production cuts
+    const auto cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+    oss << "energyRange " << cutsTable->GetLowEdgeEnergy() / eV << " " << cutsTable->GetHighEdgeEnergy() / eV << "\n";
+    for (const auto region : *G4RegionStore::GetInstance())
+    {
+      const G4ProductionCuts *cuts = region->GetProductionCuts();
+      if (!cuts)
+        continue;
+      oss << "region " << region->GetName();
+      for (const G4double cut : cuts->GetProductionCuts())
+      {
+        oss << " " << cut / mm;
+      }
+      oss << "\n";
+    }
+    return oss.str();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,191 @@
+/// \file B1/src/PrecisionTarget.cc
+/// \brief Implementation of the B1::PrecisionTarget class
+
+#include "PrecisionTarget.hh"
+#include "ExpConstants.hh"
+
+#include "G4AutoLock.hh"
+#include "G4MTRunManager.hh"
+
+#include <cmath>
+#include <cstdio>
+
+namespace B1
+{
+
+  G4bool PrecisionTarget::enabled_ = false;
+
+  namespace
+  {
+    enum class Selection
+    {
+      Coincidence,
+      Strips,
+      DeltaEE
+    };
+
+    Selection selection = Selection::Coincidence;
+    std::string targetName;
+    G4double precision = 0.;
+    G4int firstStrip = 0, lastStrip = 0;
+    G4double dEMin = 0., dEMax = 0., eMin = 0., eMax = 0.;
+
+    /// Events of the calling worker not merged yet
+    struct Counts
+    {
+      G4long events = 0;
+      G4long selected = 0;
+    };
+    thread_local Counts workerCounts;
+
+    G4Mutex masterMutex = G4MUTEX_INITIALIZER;
+    Counts masterCounts;
+    G4bool reached = false;
+
+    /// Relative uncertainty of the selected fraction, 1 without selected events
+    G4double RelativeUncertainty(const Counts &counts)
+    {
+      if (counts.selected == 0)
+        return 1.;
+      const G4double fraction = static_cast<G4double>(counts.selected) / counts.events;
+      return std::sqrt((1. - fraction) / counts.selected);
+    }
+
+    /// Adds the worker counts to the master; true when this merge reached
+    /// the precision
+    G4bool Merge()
+    {
+      G4AutoLock lock(&masterMutex);
+      masterCounts.events += workerCounts.events;
+      masterCounts.selected += workerCounts.selected;
+      workerCounts = Counts();
+      if (reached || masterCounts.events < PrecisionTarget::kMinEvents ||
+          masterCounts.selected < PrecisionTarget::kMinSelected)
+        return false;
+      reached = RelativeUncertainty(masterCounts) <= precision;
+      return reached;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool PrecisionTarget::Configure(const std::string &target, G4double requested)
+  {
+    if (requested <= 0.)
+      return true;
+
+    if (target == "coincidence")
+    {
+      selection = Selection::Coincidence;
+    }
+    else if (std::sscanf(target.c_str(), "strips:%d-%d", &firstStrip, &lastStrip) == 2 && firstStrip >= 0 &&
+             firstStrip <= lastStrip && lastStrip < kNSiStrips)
+    {
+      selection = Selection::Strips;
+    }
+    else if (std::sscanf(target.c_str(), "dee:%lf-%lf,%lf-%lf", &dEMin, &dEMax, &eMin, &eMax) == 4 &&
+             dEMin < dEMax && eMin < eMax)
+    {
+      selection = Selection::DeltaEE;
+      dEMin *= MeV;
+      dEMax *= MeV;
+      eMin *= MeV;
+      eMax *= MeV;
+    }
+    else
+    {
+      G4cerr << "Invalid precision target " << target
+             << ", expected coincidence, strips:<a>-<b> or dee:<dE0>-<dE1>,<E0>-<E1>" << G4endl;
+      return false;
+    }
+    targetName = target;
+    precision = requested;
+    enabled_ = true;
+    G4cout << "Runs stop at a relative uncertainty of " << precision << " of the " << targetName << " fraction"
+           << G4endl;
+    return true;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool PrecisionTarget::Selects(const std::map<int, double> &strips, G4double eFront,
+                                  const std::map<int, double> &csi)
+  {
+    switch (selection)
+    {
+    case Selection::Coincidence:
+    {
+      G4bool strip = false, crystal = false;
+      for (const auto &s : strips)
+        strip = strip || s.second >= kSiStripThreshold;
+      for (const auto &c : csi)
+        crystal = crystal || c.second >= kCsIThreshold;
+      return strip && crystal;
+    }
+    case Selection::Strips:
+    {
+      for (auto itr = strips.lower_bound(firstStrip); itr != strips.end() && itr->first <= lastStrip; ++itr)
+      {
+        if (itr->second >= kSiStripThreshold)
+          return true;
+      }
+      return false;
+    }
+    case Selection::DeltaEE:
+    {
+      G4double eCsI = 0.;
+      for (const auto &c : csi)
+        eCsI += c.second;
+      return eFront >= dEMin && eFront < dEMax && eCsI >= eMin && eCsI < eMax;
+    }
+    }
+    return false;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PrecisionTarget::AddEvent(G4bool selected)
+  {
+    ++workerCounts.events;
+    if (selected)
+      ++workerCounts.selected;
+    if (workerCounts.events < kMergeEvents || !Merge())
+      return;
+    // stops dispatching events and aborts the event loops of all workers
+    G4cout << "Precision target reached, aborting the remaining events of the run" << G4endl;
+    G4MTRunManager::GetMasterRunManager()->AbortRun(true);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PrecisionTarget::MergeToMaster()
+  {
+    // reaching the target now does not abort anything any more
+    Merge();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PrecisionTarget::ResetMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    masterCounts = Counts();
+    reached = false;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void PrecisionTarget::PrintMaster(std::ostream &os)
+  {
+    G4AutoLock lock(&masterMutex);
+    const G4double fraction =
+        masterCounts.events > 0 ? static_cast<G4double>(masterCounts.selected) / masterCounts.events : 0.;
+    os << " Precision target " << targetName << ": " << masterCounts.selected << " of " << masterCounts.events
+       << " events, fraction " << fraction << " +- " << RelativeUncertainty(masterCounts) * fraction << " (relative "
+       << RelativeUncertainty(masterCounts) << ", target " << precision << ", "
+       << (reached ? "reached" : "not reached") << ")" << std::endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
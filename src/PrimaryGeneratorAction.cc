@@ -28,6 +28,8 @@
 /// \brief Implementation of the B1::PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "CheckpointManager.hh"
+#include "EventSeeder.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
@@ -45,7 +47,7 @@ namespace B1
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  PrimaryGeneratorAction::PrimaryGeneratorAction()
+  PrimaryGeneratorAction::PrimaryGeneratorAction(const std::string &input_file)
   {
     G4int n_particle = 1;
     fParticleGun = new G4ParticleGun(n_particle);
@@ -58,7 +60,7 @@ namespace B1
 
     fProtonGenerator = new ProtonGenerator;
     fProtonGenerator->Clear();
-    fProtonGenerator->ReadFile("work/generated_data_2p.csv");
+    fProtonGenerator->ReadFile(input_file);
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -79,6 +81,21 @@ namespace B1
     // on DetectorConstruction class we get Envelope volume
     // from G4LogicalVolumeStore.
 
+    const int64_t eventId = EventSeeder::GlobalEventId(anEvent);
+
+    // completed by the previous attempt: no primary, not recorded
+    auto &checkpoint = CheckpointManager::Instance();
+    if (checkpoint.IsResuming() && checkpoint.IsCompleted(eventId))
+    {
+      anEvent->SetEventAborted();
+      return;
+    }
+
+    // seed and input row from the event ID, independent of the thread
+    EventSeeder::SeedEvent(eventId);
+    const u_int64_t nRows = fProtonGenerator->GetNumberOfRows();
+    fProtonGenerator->SetCursor(nRows ? static_cast<u_int64_t>(eventId) % nRows : 0);
+
     G4ThreeVector direction;
     G4ThreeVector position;
     double energy;
@@ -0,0 +1,68 @@
+/// \file B1/src/Reconstruction.cc
+/// \brief Implementation of the B1::Reconstruction class
+
+#include "Reconstruction.hh"
+#include "ExpConstants.hh"
+
+namespace B1
+{
+
+  G4bool Reconstruction::enabled_ = false;
+  G4bool Reconstruction::raw_hits_ = true;
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Reconstruction::Reconstruct(const std::map<int, double> &strips, G4double eFront,
+                                   const std::map<int, double> &csi, std::vector<RecoHit> &hits)
+  {
+    hits.clear();
+    const G4double stripWidth = kSiSize / kNSiStrips;
+
+    // clusters of adjacent strips above threshold
+    RecoHit *cluster = nullptr;
+    G4double weightedStrip = 0.;
+    G4int lastStrip = -2;
+    for (const auto &strip : strips)
+    {
+      if (strip.second < kSiStripThreshold)
+        continue;
+      if (!cluster || strip.first != lastStrip + 1)
+      {
+        if (cluster)
+          cluster->centroid = weightedStrip / cluster->eStrips;
+        hits.emplace_back();
+        cluster = &hits.back();
+        cluster->firstStrip = strip.first;
+        weightedStrip = 0.;
+      }
+      ++cluster->nStrips;
+      cluster->eStrips += strip.second;
+      weightedStrip += strip.first * strip.second;
+      lastStrip = strip.first;
+    }
+    if (cluster)
+      cluster->centroid = weightedStrip / cluster->eStrips;
+
+    // dE-E pairing
+    const G4double middle = kSiYOffset + 0.5 * kSiSize;
+    for (auto &hit : hits)
+    {
+      hit.y = kSiYOffset + hit.centroid * stripWidth;
+      hit.eFront = eFront >= kFrontSiThreshold ? eFront : 0.;
+      hit.multiplicity = static_cast<G4int>(hits.size());
+      const G4int firstCrystal = hit.y >= middle ? 0 : 2;
+      for (G4int crystal = firstCrystal; crystal < firstCrystal + 2; ++crystal)
+      {
+        const auto itr = csi.find(crystal);
+        if (itr != csi.end() && itr->second >= kCsIThreshold && itr->second > hit.eCsI)
+        {
+          hit.csiId = crystal;
+          hit.eCsI = itr->second;
+        }
+      }
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
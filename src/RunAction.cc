@@ -30,6 +30,17 @@
 #include "RunAction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "EventBatching.hh"
+#include "EventSeeder.hh"
+#include "IpcStreamSink.hh"
+#include "OutputLayout.hh"
+#include "PhaseProfiler.hh"
+#include "PrecisionTarget.hh"
+#include "RunMetadata.hh"
+#include "StepCensus.hh"
+#include "Telemetry.hh"
+#include "TruthRecorder.hh"
+#include "ThreadPlacement.hh"
 // #include "Run.hh"
 
 #include "G4RunManager.hh"
@@ -40,6 +51,10 @@
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
 namespace B1
 {
 
@@ -47,99 +62,198 @@ namespace B1
 
   RunAction::RunAction(const std::string &file_prefix) : file_prefix_(file_prefix)
   {
-    pool_ = arrow::default_memory_pool();
+    // pinned workers keep their buffers on their NUMA node, see ThreadPlacement
+    worker_pool_ = std::make_unique<WorkerMemoryPool>(ThreadPlacement::IsEnabled());
+    pool_ = worker_pool_.get();
+    G4AccumulableManager::Instance()->RegisterAccumulable(n_steps_);
+    G4AccumulableManager::Instance()->RegisterAccumulable(event_seconds_);
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-  void RunAction::BeginOfRunAction(const G4Run *)
+  void RunAction::BeginOfRunAction(const G4Run *run)
   {
     // inform the runManager to save random number seed
     G4RunManager::GetRunManager()->SetRandomNumberStore(false);
+    G4AccumulableManager::Instance()->Reset();
+    if (PhaseProfiler::kEnabled && IsMaster())
+      PhaseProfiler::ResetMaster();
+    if (StepCensus::IsEnabled() && IsMaster())
+      StepCensus::ResetMaster();
+    if (IsMaster())
+      WorkerMemoryPool::ResetMaster();
+    if (PrecisionTarget::IsEnabled() && IsMaster())
+      PrecisionTarget::ResetMaster();
+    timer_.Start();
+    run_id_ = run->GetRunID();
     const u_int64_t nevent = G4RunManager::GetRunManager()->GetNumberOfEventsToBeProcessed();
-    const int nworkers = G4Threading::G4GetNumberOfCores();
-    const u_int64_t nevnet_per_worker = nevent / nworkers;
 
+    // the master sets the share of the workers before they begin the run
+    static G4long eventsPerWorker = 0;
+    if (IsMaster())
+      eventsPerWorker = nevent / std::max(G4RunManager::GetRunManager()->GetNumberOfThreads(), 1);
+    else
+      ComputeReservation(eventsPerWorker);
+    InitializeBuilders(G4Threading::G4GetThreadId());
+    if (Telemetry::IsEnabled() && IsMaster())
+      Telemetry::StartRun(nevent);
+
+    auto &checkpoint = CheckpointManager::Instance();
+    if (checkpoint.IsEnabled())
+    {
+      if (IsMaster())
+      {
+        checkpoint.BeginRun(file_prefix_, run->GetRunID(), nevent);
+      }
+      else
+      {
+        // continue the part numbering of the previous attempt; the events
+        // reseed their engine from their ID, see EventSeeder
+        part_ = checkpoint.GetWorkerState(worker_id_).parts;
+      }
+      events_since_checkpoint_ = 0;
+      pending_ranges_.clear();
+    }
+
+    if (IsMaster())
+    {
+      EventSeeder::BeginRun(run->GetRunID());
+      EventBatching::BeginRun(nevent);
+      RunMetadata::BeginRun(run->GetRunID());
+      std::filesystem::create_directories(RunMetadata::PartitionDir(file_prefix_, "eDep", run_id_));
+      std::filesystem::create_directories(RunMetadata::PartitionDir(file_prefix_, "evtInfo", run_id_));
+      if (Reconstruction::IsEnabled())
+        std::filesystem::create_directories(RunMetadata::PartitionDir(file_prefix_, "reco", run_id_));
+      if (TruthRecorder::IsEnabled())
+        std::filesystem::create_directories(RunMetadata::PartitionDir(file_prefix_, "truth", run_id_));
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::InitializeBuilders(int workerId)
+  {
+    CreateBuilders();
+    eDep_batches_.clear();
+    evt_info_batches_.clear();
+    reco_batches_.clear();
+    events_in_batch_ = 0;
+    worker_id_ = workerId;
+    event_id_ = 0;
+    n_run_events_ = 0;
+    n_run_hits_ = 0;
+    buffered_bytes_ = 0;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::ComputeReservation(G4long eventsPerWorker)
+  {
+    if (n_run_events_ > 0)
+      hits_per_event_ = static_cast<G4double>(n_run_hits_) / n_run_events_;
+
+    G4long events = eventsPerWorker;
+    auto &checkpoint = CheckpointManager::Instance();
+    if (checkpoint.IsEnabled())
+      events = std::min<G4long>(events, checkpoint.GetInterval());
+    if (IpcStreamSink::IsEnabled())
+      events = std::min<G4long>(events, IpcStreamSink::GetBatchEvents());
+    // bytes per event: event info and hits with short detector names
+    const G4double eventBytes = 36. + hits_per_event_ * (28. + 4.);
+    if (events * eventBytes > kMaxReservedBytes)
+      events = static_cast<G4long>(kMaxReservedBytes / eventBytes);
+    reserved_events_ = events;
+    reserved_hits_ = static_cast<G4long>(events * hits_per_event_);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::CreateBuilders()
+  {
     // Initialize Array builders
     builder_map_.clear();
     builder_map_["workerId"] = std::make_shared<arrow::Int32Builder>(pool_);
-    builder_map_["eventId"] = std::make_shared<arrow::Int32Builder>(pool_);
+    builder_map_["eventId"] = std::make_shared<arrow::Int64Builder>(pool_);
     builder_map_["detName"] = std::make_shared<arrow::StringBuilder>(pool_);
     builder_map_["copyId"] = std::make_shared<arrow::Int32Builder>(pool_);
     builder_map_["eDep"] = std::make_shared<arrow::DoubleBuilder>(pool_);
 
+    event_info_builder_map_.clear();
     event_info_builder_map_["workerId"] = std::make_shared<arrow::Int32Builder>(pool_);
-    event_info_builder_map_["eventId"] = std::make_shared<arrow::Int32Builder>(pool_);
+    event_info_builder_map_["eventId"] = std::make_shared<arrow::Int64Builder>(pool_);
     event_info_builder_map_["eProton"] = std::make_shared<arrow::DoubleBuilder>(pool_);
     event_info_builder_map_["theta"] = std::make_shared<arrow::DoubleBuilder>(pool_);
     event_info_builder_map_["phi"] = std::make_shared<arrow::DoubleBuilder>(pool_);
 
-    worker_id_ = G4Threading::G4GetThreadId();
-    n_worker_event_ = worker_id_ * nevnet_per_worker;
+    reco_builder_map_.clear();
+    if (Reconstruction::IsEnabled())
+    {
+      reco_builder_map_["workerId"] = std::make_shared<arrow::Int32Builder>(pool_);
+      reco_builder_map_["eventId"] = std::make_shared<arrow::Int64Builder>(pool_);
+      reco_builder_map_["firstStrip"] = std::make_shared<arrow::Int32Builder>(pool_);
+      reco_builder_map_["nStrips"] = std::make_shared<arrow::Int32Builder>(pool_);
+      reco_builder_map_["centroid"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["y"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["eStrips"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["eFront"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["csiId"] = std::make_shared<arrow::Int32Builder>(pool_);
+      reco_builder_map_["eCsI"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["eTotal"] = std::make_shared<arrow::DoubleBuilder>(pool_);
+      reco_builder_map_["multiplicity"] = std::make_shared<arrow::Int32Builder>(pool_);
+    }
+
+    // grow once instead of doubling through the run
+    if (reserved_events_ > 0)
+    {
+      for (auto &builder : builder_map_)
+        PARQUET_THROW_NOT_OK(builder.second->Reserve(reserved_hits_));
+      PARQUET_THROW_NOT_OK(
+          static_cast<arrow::StringBuilder *>(builder_map_["detName"].get())->ReserveData(4 * reserved_hits_));
+      for (auto &builder : event_info_builder_map_)
+        PARQUET_THROW_NOT_OK(builder.second->Reserve(reserved_events_));
+      for (auto &builder : reco_builder_map_)
+        PARQUET_THROW_NOT_OK(builder.second->Reserve(reserved_events_));
+    }
   }
 
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
   void RunAction::EndOfRunAction(const G4Run *run)
   {
+    timer_.Stop();
+    if (IsMaster())
+      EventSeeder::EndRun();
+    if (Telemetry::IsEnabled() && IsMaster())
+      Telemetry::StopRun();
     G4int nofEvents = run->GetNumberOfEvent();
     if (nofEvents == 0)
       return;
 
-    // Finalize arrays
-    std::vector<std::string> cols = {"workerId", "eventId", "detName", "copyId", "eDep"};
-    arrow::ArrayVector arrayVec;
-    for (const auto &col : cols)
+    // Merge the step counts of the workers into the master
+    G4AccumulableManager::Instance()->Merge();
+
+    auto &checkpoint = CheckpointManager::Instance();
+    if (!checkpoint.IsEnabled())
     {
-      std::shared_ptr<arrow::Array> array;
-      PARQUET_THROW_NOT_OK(builder_map_[col]->Finish(&array));
-      arrayVec.emplace_back(array);
+      const std::string threadId = std::to_string(G4Threading::G4GetThreadId());
+      WriteTables(RunMetadata::PartitionDir(file_prefix_, "eDep", run_id_) + "/worker" + threadId + ".parquet",
+                  RunMetadata::PartitionDir(file_prefix_, "evtInfo", run_id_) + "/worker_" + threadId + ".parquet",
+                  RunMetadata::PartitionDir(file_prefix_, "reco", run_id_) + "/worker_" + threadId + ".parquet",
+                  RunMetadata::PartitionDir(file_prefix_, "truth", run_id_) + "/worker_" + threadId + ".parquet");
     }
-    std::vector<std::string> evt_cols = {"workerId", "eventId", "eProton", "theta", "phi"};
-    arrow::ArrayVector evt_arrayVec;
-    for (const auto &col : evt_cols)
+    else if (!IsMaster() && !pending_ranges_.empty())
     {
-      std::shared_ptr<arrow::Array> array;
-      PARQUET_THROW_NOT_OK(event_info_builder_map_[col]->Finish(&array));
-      evt_arrayVec.emplace_back(array);
+      // last part of the worker
+      WriteCheckpoint(false);
     }
-
-    // Create schema
-    arrow::FieldVector fieldVec;
-    fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
-    fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int32()));
-    fieldVec.emplace_back(std::make_shared<arrow::Field>("detName", arrow::utf8()));
-    fieldVec.emplace_back(std::make_shared<arrow::Field>("copyId", arrow::int32()));
-    fieldVec.emplace_back(std::make_shared<arrow::Field>("eDep", arrow::float64()));
-    auto schema = arrow::schema(fieldVec);
-
-    arrow::FieldVector evt_fieldVec;
-    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
-    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int32()));
-    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("eProton", arrow::float64()));
-    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("theta", arrow::float64()));
-    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("phi", arrow::float64()));
-    auto evt_schema = arrow::schema(evt_fieldVec);
-
-    // Write table to file
-    G4int threadId = G4Threading::G4GetThreadId();
-    std::string filename = file_prefix_ + "/eDep/worker" + std::to_string(threadId) + ".parquet";
-    auto table = arrow::Table::Make(schema, arrayVec);
-    std::shared_ptr<arrow::io::FileOutputStream> outfile;
-    PARQUET_ASSIGN_OR_THROW(
-        outfile,
-        arrow::io::FileOutputStream::Open(filename));
-
-    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, pool_, outfile));
-
-    std::string evt_filename = file_prefix_ + "/evtInfo/worker_" + std::to_string(threadId) + ".parquet";
-    auto evt_table = arrow::Table::Make(evt_schema, evt_arrayVec);
-    std::shared_ptr<arrow::io::FileOutputStream> evt_outfile;
-    PARQUET_ASSIGN_OR_THROW(
-        evt_outfile,
-        arrow::io::FileOutputStream::Open(evt_filename));
-
-    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*evt_table, pool_, evt_outfile));
+    if (PhaseProfiler::kEnabled && !IsMaster())
+      PhaseProfiler::Instance().MergeToMaster();
+    if (StepCensus::IsEnabled() && !IsMaster())
+      StepCensus::Instance().MergeToMaster();
+    if (!IsMaster())
+      worker_pool_->MergeToMaster();
+    if (PrecisionTarget::IsEnabled() && !IsMaster())
+      PrecisionTarget::MergeToMaster();
 
     // Run conditions
     //  note: There is no primary generator action object for "master"
@@ -174,26 +288,277 @@ namespace B1
     G4cout
         << G4endl
         << " The run consists of " << nofEvents << " " << runCondition
+        << G4endl
+        << " and " << n_steps_.GetValue() << " steps in " << timer_.GetRealElapsed() << " s"
         << G4endl;
+
+    if (IsMaster())
+    {
+      if (checkpoint.IsEnabled())
+        checkpoint.EndRun();
+      WriteRunStats(nofEvents);
+      WorkerMemoryPool::PrintMaster(G4cout);
+      IpcStreamSink::PrintRunSummary(G4cout);
+      if (PrecisionTarget::IsEnabled())
+        PrecisionTarget::PrintMaster(G4cout);
+      EventBatching::EndRun(nofEvents, event_seconds_.GetValue());
+      if (PhaseProfiler::kEnabled)
+      {
+        PhaseProfiler::PrintMaster(G4cout);
+        PhaseProfiler::WriteMaster(file_prefix_ + "/run_profile.txt");
+      }
+      if (StepCensus::IsEnabled())
+      {
+        StepCensus::PrintMaster(G4cout);
+        StepCensus::WriteMaster(file_prefix_ + "/step_census.txt");
+      }
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::WriteRunStats(G4int nofEvents) const
+  {
+    std::ofstream fout(file_prefix_ + "/run_stats.txt");
+    if (!fout)
+    {
+      G4cerr << "Cannot write " << file_prefix_ << "/run_stats.txt" << G4endl;
+      return;
+    }
+    fout << "events " << nofEvents << "\n"
+         << "steps " << n_steps_.GetValue() << "\n"
+         << "runTime " << timer_.GetRealElapsed() << "\n";
+  }
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::EventDone(int64_t eventId)
+  {
+    if (IpcStreamSink::IsEnabled() && ++events_in_batch_ >= IpcStreamSink::GetBatchEvents())
+      FinishBatch();
+    auto &checkpoint = CheckpointManager::Instance();
+    if (!checkpoint.IsEnabled())
+      return;
+    CheckpointManager::AddToRanges(pending_ranges_, eventId);
+    if (++events_since_checkpoint_ >= checkpoint.GetInterval())
+      WriteCheckpoint(true);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::WriteCheckpoint(G4bool moreEvents)
+  {
+    auto &checkpoint = CheckpointManager::Instance();
+    WriteTables(CheckpointManager::EDepPartFile(file_prefix_, run_id_, worker_id_, part_),
+                CheckpointManager::EvtInfoPartFile(file_prefix_, run_id_, worker_id_, part_),
+                CheckpointManager::RecoPartFile(file_prefix_, run_id_, worker_id_, part_),
+                CheckpointManager::TruthPartFile(file_prefix_, run_id_, worker_id_, part_), moreEvents);
+    buffered_bytes_ = 0;
+    ++part_;
+
+    const auto generatorAction = static_cast<const PrimaryGeneratorAction *>(
+        G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction());
+    checkpoint.Commit(worker_id_, part_, generatorAction ? generatorAction->GetCursor() : 0, pending_ranges_);
+    pending_ranges_.clear();
+    events_since_checkpoint_ = 0;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<arrow::Schema> RunAction::EDepSchema()
+  {
+    arrow::FieldVector fieldVec;
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int64()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("detName", arrow::utf8()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("copyId", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("eDep", arrow::float64()));
+    return arrow::schema(fieldVec);
+  }
+
+  std::shared_ptr<arrow::Schema> RunAction::EvtInfoSchema()
+  {
+    arrow::FieldVector evt_fieldVec;
+    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
+    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int64()));
+    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("eProton", arrow::float64()));
+    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("theta", arrow::float64()));
+    evt_fieldVec.emplace_back(std::make_shared<arrow::Field>("phi", arrow::float64()));
+    return arrow::schema(evt_fieldVec);
+  }
+
+  std::shared_ptr<arrow::Schema> RunAction::RecoSchema()
+  {
+    arrow::FieldVector reco_fieldVec;
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("firstStrip", arrow::int32()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("nStrips", arrow::int32()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("centroid", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("y", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("eStrips", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("eFront", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("csiId", arrow::int32()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("eCsI", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("eTotal", arrow::float64()));
+    reco_fieldVec.emplace_back(std::make_shared<arrow::Field>("multiplicity", arrow::int32()));
+    return arrow::schema(reco_fieldVec);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::FinishBatch(G4bool moreEvents)
+  {
+    // Finalize arrays
+    std::vector<std::string> cols = {"workerId", "eventId", "detName", "copyId", "eDep"};
+    arrow::ArrayVector arrayVec;
+    for (const auto &col : cols)
+    {
+      std::shared_ptr<arrow::Array> array;
+      PARQUET_THROW_NOT_OK(builder_map_[col]->Finish(&array));
+      arrayVec.emplace_back(array);
+    }
+    std::vector<std::string> evt_cols = {"workerId", "eventId", "eProton", "theta", "phi"};
+    arrow::ArrayVector evt_arrayVec;
+    for (const auto &col : evt_cols)
+    {
+      std::shared_ptr<arrow::Array> array;
+      PARQUET_THROW_NOT_OK(event_info_builder_map_[col]->Finish(&array));
+      evt_arrayVec.emplace_back(array);
+    }
+    const auto recoSchema = RecoSchema();
+    arrow::ArrayVector reco_arrayVec;
+    if (!reco_builder_map_.empty())
+    {
+      for (const auto &field : recoSchema->fields())
+      {
+        std::shared_ptr<arrow::Array> array;
+        PARQUET_THROW_NOT_OK(reco_builder_map_[field->name()]->Finish(&array));
+        reco_arrayVec.emplace_back(array);
+      }
+    }
+    // a finished builder is empty and can still append, but has released its
+    // reservation
+    if (moreEvents)
+      CreateBuilders();
+    events_in_batch_ = 0;
+
+    const int64_t nHits = arrayVec.front()->length();
+    const int64_t nEvents = evt_arrayVec.front()->length();
+    if (nHits > 0)
+    {
+      eDep_batches_.emplace_back(arrow::RecordBatch::Make(EDepSchema(), nHits, arrayVec));
+      if (IpcStreamSink::IsEnabled())
+        IpcStreamSink::Publish(IpcStreamSink::Table::EDep, eDep_batches_.back());
+    }
+    if (nEvents > 0)
+    {
+      evt_info_batches_.emplace_back(arrow::RecordBatch::Make(EvtInfoSchema(), nEvents, evt_arrayVec));
+      if (IpcStreamSink::IsEnabled())
+        IpcStreamSink::Publish(IpcStreamSink::Table::EvtInfo, evt_info_batches_.back());
+    }
+    // the reconstructed hits are not streamed
+    if (!reco_arrayVec.empty() && reco_arrayVec.front()->length() > 0)
+      reco_batches_.emplace_back(arrow::RecordBatch::Make(recoSchema, reco_arrayVec.front()->length(), reco_arrayVec));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::WriteTables(const std::string &eDepFile, const std::string &evtInfoFile,
+                              const std::string &recoFile, const std::string &truthFile, G4bool moreEvents)
+  {
+    OCTUPOLE_PROFILE_SCOPE(Phase::ParquetWrite);
+    FinishBatch(moreEvents);
+
+    // configuration of the run, embedded in every file; the benchmarks
+    // write tables without a run manager
+    const auto runManager = G4RunManager::GetRunManager();
+    const auto generatorAction = runManager
+                                     ? static_cast<const PrimaryGeneratorAction *>(
+                                           runManager->GetUserPrimaryGeneratorAction())
+                                     : nullptr;
+    const auto metadata = RunMetadata::Make(worker_id_, generatorAction ? generatorAction->GetParticleGun() : nullptr);
+
+    // Write table to file
+    if (Reconstruction::RawHits())
+    {
+      std::shared_ptr<arrow::Table> table;
+      PARQUET_ASSIGN_OR_THROW(table, arrow::Table::FromRecordBatches(EDepSchema(), eDep_batches_));
+      OutputLayout::Write(table->ReplaceSchemaMetadata(metadata), eDepFile, pool_);
+    }
+
+    std::shared_ptr<arrow::Table> evt_table;
+    PARQUET_ASSIGN_OR_THROW(evt_table, arrow::Table::FromRecordBatches(EvtInfoSchema(), evt_info_batches_));
+    OutputLayout::Write(evt_table->ReplaceSchemaMetadata(metadata), evtInfoFile, pool_);
+
+    if (Reconstruction::IsEnabled() && !recoFile.empty())
+    {
+      std::shared_ptr<arrow::Table> reco_table;
+      PARQUET_ASSIGN_OR_THROW(reco_table, arrow::Table::FromRecordBatches(RecoSchema(), reco_batches_));
+      OutputLayout::Write(reco_table->ReplaceSchemaMetadata(metadata), recoFile, pool_);
+    }
+
+    if (TruthRecorder::IsEnabled() && !truthFile.empty())
+    {
+      const auto truth_table = TruthRecorder::Instance().Finish(worker_id_, pool_);
+      OutputLayout::Write(truth_table->ReplaceSchemaMetadata(metadata), truthFile, pool_);
+    }
+
+    eDep_batches_.clear();
+    evt_info_batches_.clear();
+    reco_batches_.clear();
   }
+
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
   void RunAction::AddEdep(const std::string &detName, const G4double &eDep, G4int copyNum)
   {
+    OCTUPOLE_PROFILE_SCOPE(Phase::ArrowAppendHit);
     PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(builder_map_["workerId"].get())->Append(worker_id_));
-    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(builder_map_["eventId"].get())->Append(n_worker_event_));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int64Builder *>(builder_map_["eventId"].get())->Append(event_id_));
     PARQUET_THROW_NOT_OK(static_cast<arrow::StringBuilder *>(builder_map_["detName"].get())->Append(detName));
     PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(builder_map_["copyId"].get())->Append(copyNum));
     PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(builder_map_["eDep"].get())->Append(eDep));
+    ++n_run_hits_;
+    // 2 int32, 1 int64, 1 double, string offset and characters
+    buffered_bytes_ += 28 + detName.size();
   }
 
   void RunAction::AddEventInfo(const double &energy, const G4double &theta, const G4double &phi)
   {
+    OCTUPOLE_PROFILE_SCOPE(Phase::ArrowAppendEvent);
     PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(event_info_builder_map_["workerId"].get())->Append(worker_id_));
-    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(event_info_builder_map_["eventId"].get())->Append(n_worker_event_));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int64Builder *>(event_info_builder_map_["eventId"].get())->Append(event_id_));
     PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(event_info_builder_map_["eProton"].get())->Append(energy));
     PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(event_info_builder_map_["theta"].get())->Append(theta));
     PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(event_info_builder_map_["phi"].get())->Append(phi));
+    // 1 int32, 1 int64, 3 double
+    buffered_bytes_ += 36;
+  }
+
+  void RunAction::AddRecoHit(const RecoHit &hit)
+  {
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(reco_builder_map_["workerId"].get())->Append(worker_id_));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int64Builder *>(reco_builder_map_["eventId"].get())->Append(event_id_));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(reco_builder_map_["firstStrip"].get())->Append(hit.firstStrip));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(reco_builder_map_["nStrips"].get())->Append(hit.nStrips));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["centroid"].get())->Append(hit.centroid));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["y"].get())->Append(hit.y));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["eStrips"].get())->Append(hit.eStrips));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["eFront"].get())->Append(hit.eFront));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(reco_builder_map_["csiId"].get())->Append(hit.csiId));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["eCsI"].get())->Append(hit.eCsI));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::DoubleBuilder *>(reco_builder_map_["eTotal"].get())->Append(hit.ETotal()));
+    PARQUET_THROW_NOT_OK(static_cast<arrow::Int32Builder *>(reco_builder_map_["multiplicity"].get())->Append(hit.multiplicity));
+    // 5 int32, 1 int64, 6 double
+    buffered_bytes_ += 76;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunAction::PublishTelemetry() const
+  {
+    Telemetry::Publish(worker_id_, n_run_events_, n_run_hits_, buffered_bytes_);
   }
+
   //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 }
\ No newline at end of file
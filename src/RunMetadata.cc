@@ -0,0 +1,106 @@
+/// \file B1/src/RunMetadata.cc
+/// \brief Implementation of the B1::RunMetadata class
+
+#include "RunMetadata.hh"
+#include "EventSeeder.hh"
+#include "ExpConstants.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleGun.hh"
+#include "G4RunManager.hh"
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace B1
+{
+
+  namespace
+  {
+    // written by the master before the workers start a run
+    std::map<std::string, std::string> jobEntries;
+    std::map<std::string, std::string> runEntries;
+
+    std::string ToString(G4double value)
+    {
+      std::ostringstream os;
+      os.precision(10);
+      os << value;
+      return os.str();
+    }
+
+    std::map<std::string, std::string> GeometryEntries()
+    {
+      return {
+          {"geometry.kNSiStrips", std::to_string(kNSiStrips)},
+          {"geometry.kSiSize", ToString(kSiSize / mm)},
+          {"geometry.kSiThickness", ToString(kSiThickness / mm)},
+          {"geometry.kFrontSiThickness", ToString(kFrontSiThickness / mm)},
+          {"geometry.kSiXOffset", ToString(kSiXOffset / mm)},
+          {"geometry.kSiYOffset", ToString(kSiYOffset / mm)},
+          {"geometry.kSiZOffset", ToString(kSiZOffset / mm)},
+          {"geometry.kCsISize", ToString(kCsISize / mm)},
+          {"geometry.kCsIThickness", ToString(kCsIThickness / mm)},
+          {"geometry.kCsIZOffset", ToString(kCsIZOffset / mm)},
+          {"geometry.kTargetThickness", ToString(kTargetThickness / mm)},
+          {"geometry.kTargetRadius", ToString(kTargetRadius / mm)},
+          {"geometry.kRotation",
+           ToString(kRotation.phi() / deg) + " " + ToString(kRotation.theta() / deg) + " " +
+               ToString(kRotation.psi() / deg)},
+          {"geometry.kPosition",
+           ToString(kPosition.x() / mm) + " " + ToString(kPosition.y() / mm) + " " + ToString(kPosition.z() / mm)},
+      };
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunMetadata::Set(const std::string &key, const std::string &value)
+  {
+    jobEntries[key] = value;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void RunMetadata::BeginRun(G4int runId)
+  {
+    runEntries.clear();
+    runEntries["runId"] = std::to_string(runId);
+    runEntries["threads"] = std::to_string(G4RunManager::GetRunManager()->GetNumberOfThreads());
+    // the engines keep no list of the seeds they were given: the full state
+    // the event seeds derive from, restored with G4Random::getTheEngine()->get()
+    runEntries["engineStatus"] = EventSeeder::GetSeedStatus();
+    runEntries["eventBaseSeed"] = std::to_string(EventSeeder::GetBaseSeed());
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<const arrow::KeyValueMetadata> RunMetadata::Make(G4int workerId, const G4ParticleGun *gun)
+  {
+    std::map<std::string, std::string> entries = GeometryEntries();
+    entries.insert(jobEntries.begin(), jobEntries.end());
+    entries.insert(runEntries.begin(), runEntries.end());
+    entries["workerId"] = std::to_string(workerId);
+    if (gun && gun->GetParticleDefinition())
+      entries["particle"] = gun->GetParticleDefinition()->GetParticleName();
+
+    std::vector<std::string> keys, values;
+    for (const auto &entry : entries)
+    {
+      keys.emplace_back("octupole." + entry.first);
+      values.emplace_back(entry.second);
+    }
+    return arrow::key_value_metadata(keys, values);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string RunMetadata::PartitionDir(const std::string &prefix, const std::string &table, G4int runId)
+  {
+    return prefix + "/" + table + "/run=" + std::to_string(runId);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,161 @@
+/// \file B1/src/Sharding.cc
+/// \brief Implementation of the B1::Sharding class
+
+#include "Sharding.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace B1
+{
+
+  G4int Sharding::index_ = 0;
+  G4int Sharding::count_ = 0;
+  std::string Sharding::dataset_prefix_;
+  int64_t Sharding::n_total_ = 0;
+  int64_t Sharding::event_id_offset_ = 0;
+  G4int Sharding::run_id_ = 0;
+
+  namespace
+  {
+    /// Writes a file through a temporary and a rename, so that concurrent
+    /// writers of the same content and readers never see a partial file
+    template <class Writer>
+    void WriteAtomically(const std::string &fname, Writer write)
+    {
+      const std::string tmpName = fname + ".tmp" + std::to_string(getpid());
+      {
+        std::ofstream fout(tmpName);
+        write(fout);
+        if (!fout)
+        {
+          G4cerr << "Cannot write " << tmpName << G4endl;
+          return;
+        }
+      }
+      std::error_code ec;
+      fs::rename(tmpName, fname, ec);
+      if (ec)
+        G4cerr << "Cannot replace " << fname << ": " << ec.message() << G4endl;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool Sharding::ParseSpec(const std::string &spec, G4int &index, G4int &count)
+  {
+    const auto slash = spec.find('/');
+    if (slash == std::string::npos || slash == 0 || slash + 1 == spec.size())
+      return false;
+    char *end = nullptr;
+    index = std::strtol(spec.c_str(), &end, 10);
+    if (end != spec.c_str() + slash)
+      return false;
+    count = std::strtol(spec.c_str() + slash + 1, &end, 10);
+    if (*end != '\0')
+      return false;
+    return count > 0 && index >= 0 && index < count;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Sharding::Configure(G4int index, G4int count, const std::string &datasetPrefix)
+  {
+    index_ = index;
+    count_ = count;
+    dataset_prefix_ = datasetPrefix;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string Sharding::ShardPrefix(const std::string &datasetPrefix, G4int index, G4int count)
+  {
+    return datasetPrefix + "/shard" + std::to_string(index) + "of" + std::to_string(count);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::pair<int64_t, int64_t> Sharding::Range(int64_t nTotal, G4int index, G4int count)
+  {
+    const int64_t first = nTotal * index / count;
+    const int64_t last = nTotal * (index + 1) / count;
+    return {first, last - first};
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4int Sharding::BeginRun(G4int nTotal, G4int runId)
+  {
+    n_total_ = nTotal;
+    run_id_ = runId;
+    const auto range = Range(nTotal, index_, count_);
+    event_id_offset_ = range.first;
+
+    // the tables are partitioned by run, see RunMetadata
+    const std::string prefix = ShardPrefix(dataset_prefix_, index_, count_);
+    fs::create_directories(RunDir(prefix));
+    fs::create_directories(RunDir(dataset_prefix_));
+    WriteShardFile(false);
+    WriteDatasetFile();
+
+    G4cout << "Shard " << index_ << "/" << count_ << ", run " << runId << ": events " << range.first << " to "
+           << range.first + range.second - 1 << " of " << nTotal << " in " << prefix << G4endl;
+    return static_cast<G4int>(range.second);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Sharding::EndRun()
+  {
+    WriteShardFile(true);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::string Sharding::RunDir(const std::string &prefix)
+  {
+    return prefix + "/run=" + std::to_string(run_id_);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Sharding::WriteShardFile(G4bool complete)
+  {
+    const auto range = Range(n_total_, index_, count_);
+    WriteAtomically(RunDir(ShardPrefix(dataset_prefix_, index_, count_)) + "/shard.txt", [&](std::ofstream &fout) {
+      fout << "octupoleShard 2\n"
+           << "run " << run_id_ << "\n"
+           << "shard " << index_ << "\n"
+           << "shards " << count_ << "\n"
+           << "firstEvent " << range.first << "\n"
+           << "events " << range.second << "\n"
+           << "complete " << complete << "\n";
+    });
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Sharding::WriteDatasetFile()
+  {
+    // identical for all shards of the dataset
+    WriteAtomically(RunDir(dataset_prefix_) + "/dataset.txt", [&](std::ofstream &fout) {
+      fout << "octupoleDataset 2\n"
+           << "run " << run_id_ << "\n"
+           << "shards " << count_ << "\n"
+           << "events " << n_total_ << "\n";
+      for (G4int i = 0; i < count_; ++i)
+      {
+        const auto range = Range(n_total_, i, count_);
+        fout << "shard " << i << " " << fs::path(ShardPrefix("", i, count_)).filename().string() << " "
+             << range.first << " " << range.second << "\n";
+      }
+    });
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,202 @@
+/// \file B1/src/StepCensus.cc
+/// \brief Implementation of the B1::StepCensus class
+
+#include "StepCensus.hh"
+#include "PhaseProfiler.hh"
+
+#include "G4AutoLock.hh"
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VProcess.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace B1
+{
+
+  G4bool StepCensus::enabled_ = false;
+
+  namespace
+  {
+    /// (volume, particle, creator process)
+    using CensusKey = std::tuple<std::string, std::string, std::string>;
+
+    struct CensusCounts
+    {
+      uint64_t steps = 0;
+      uint64_t tracks = 0;
+      uint64_t ticks = 0;
+    };
+
+    G4Mutex masterMutex = G4MUTEX_INITIALIZER;
+    std::map<CensusKey, CensusCounts> masterCensus;
+    // ticks since ResetMaster()
+    TickCalibration calibration;
+
+    /// Master totals sorted by decreasing number of steps
+    std::vector<std::pair<CensusKey, CensusCounts>> SortedCensus(uint64_t &totalSteps, uint64_t &totalTicks)
+    {
+      std::vector<std::pair<CensusKey, CensusCounts>> sorted(masterCensus.begin(), masterCensus.end());
+      std::sort(sorted.begin(), sorted.end(),
+                [](const auto &a, const auto &b) { return a.second.steps > b.second.steps; });
+      totalSteps = totalTicks = 0;
+      for (const auto &entry : sorted)
+      {
+        totalSteps += entry.second.steps;
+        totalTicks += entry.second.ticks;
+      }
+      return sorted;
+    }
+
+    void PrintCensus(std::ostream &os, const std::vector<std::pair<CensusKey, CensusCounts>> &sorted,
+                     size_t nLines, uint64_t totalSteps, uint64_t totalTicks)
+    {
+      const double ticksPerSecond = calibration.TicksPerSecond();
+      os << std::setw(16) << std::left << "volume" << std::setw(12) << "particle" << std::setw(20) << "creator"
+         << std::right << std::setw(14) << "steps" << std::setw(12) << "tracks" << std::setw(12) << "time[s]"
+         << std::setw(9) << "%steps" << std::setw(9) << "%time" << std::endl;
+      for (size_t i = 0; i < sorted.size() && i < nLines; ++i)
+      {
+        const auto &key = sorted[i].first;
+        const auto &counts = sorted[i].second;
+        os << std::setw(16) << std::left << std::get<0>(key) << std::setw(12) << std::get<1>(key) << std::setw(20)
+           << std::get<2>(key) << std::right << std::setw(14) << counts.steps << std::setw(12) << counts.tracks
+           << std::setw(12) << std::setprecision(4) << counts.ticks / ticksPerSecond << std::setw(9)
+           << std::setprecision(3) << (totalSteps ? 100. * counts.steps / totalSteps : 0.) << std::setw(9)
+           << (totalTicks ? 100. * counts.ticks / totalTicks : 0.) << std::endl;
+      }
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  StepCensus &StepCensus::Instance()
+  {
+    static thread_local StepCensus census;
+    return census;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::BeginEvent()
+  {
+    last_ticks_ = PhaseProfiler::ReadTicks();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::Record(const G4Step *step)
+  {
+    const uint64_t now = PhaseProfiler::ReadTicks();
+    const G4Track *track = step->GetTrack();
+    Entry *entry = Find(step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume(),
+                        track->GetParticleDefinition(), track->GetCreatorProcess());
+    ++entry->steps;
+    if (track->GetCurrentStepNumber() == 1)
+      ++entry->tracks;
+    entry->ticks += now - last_ticks_;
+    last_ticks_ = now;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  StepCensus::Entry *StepCensus::Find(const G4LogicalVolume *volume, const G4ParticleDefinition *particle,
+                                      const G4VProcess *creator)
+  {
+    size_t hash = reinterpret_cast<uintptr_t>(volume) * 0x9E3779B97F4A7C15ull;
+    hash ^= reinterpret_cast<uintptr_t>(particle) + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    hash ^= reinterpret_cast<uintptr_t>(creator) + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+
+    // open addressing with linear probing; volumes are never null, so a
+    // null volume marks a free slot
+    for (int probe = 0; probe < kTableSize; ++probe)
+    {
+      Entry &entry = table_[(hash + probe) & (kTableSize - 1)];
+      if (entry.volume == volume && entry.particle == particle && entry.creator == creator)
+        return &entry;
+      if (!entry.volume)
+      {
+        entry.volume = volume;
+        entry.particle = particle;
+        entry.creator = creator;
+        return &entry;
+      }
+    }
+    return &overflow_;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::MergeToMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    auto add = [](const CensusKey &key, const Entry &entry) {
+      auto &counts = masterCensus[key];
+      counts.steps += entry.steps;
+      counts.tracks += entry.tracks;
+      counts.ticks += entry.ticks;
+    };
+    for (auto &entry : table_)
+    {
+      if (!entry.volume)
+        continue;
+      // process objects are thread-local, their names are not
+      add(CensusKey(entry.volume->GetName(), entry.particle->GetParticleName(),
+                    entry.creator ? G4String(entry.creator->GetProcessName()) : G4String("primary")),
+          entry);
+      entry = Entry();
+    }
+    if (overflow_.steps)
+    {
+      add(CensusKey("overflow", "-", "-"), overflow_);
+      overflow_ = Entry();
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::ResetMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    masterCensus.clear();
+    calibration.Start();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::PrintMaster(std::ostream &os, int nLines)
+  {
+    G4AutoLock lock(&masterMutex);
+    uint64_t totalSteps, totalTicks;
+    const auto sorted = SortedCensus(totalSteps, totalTicks);
+    os << " Step census, " << totalSteps << " steps in " << sorted.size() << " combinations:" << std::endl;
+    PrintCensus(os, sorted, nLines, totalSteps, totalTicks);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void StepCensus::WriteMaster(const std::string &fname)
+  {
+    std::ofstream fout(fname);
+    if (!fout)
+    {
+      G4cerr << "Cannot write " << fname << G4endl;
+      return;
+    }
+    G4AutoLock lock(&masterMutex);
+    uint64_t totalSteps, totalTicks;
+    const auto sorted = SortedCensus(totalSteps, totalTicks);
+    PrintCensus(fout, sorted, sorted.size(), totalSteps, totalTicks);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
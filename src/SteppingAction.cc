@@ -30,6 +30,9 @@
 #include "SteppingAction.hh"
 #include "EventAction.hh"
 #include "DetectorConstruction.hh"
+#include "PhaseProfiler.hh"
+#include "StepCensus.hh"
+#include "TruthRecorder.hh"
 
 #include "G4Step.hh"
 #include "G4Event.hh"
@@ -50,6 +53,7 @@ namespace B1
 
   void SteppingAction::UserSteppingAction(const G4Step *step)
   {
+    OCTUPOLE_PROFILE_SCOPE(Phase::Stepping);
     if (!fScoringVolume)
     {
       const auto detConstruction = static_cast<const DetectorConstruction *>(
@@ -57,6 +61,16 @@ namespace B1
       fScoringVolume = detConstruction->GetScoringVolume();
     }
 
+    fEventAction->AddStep();
+    if (StepCensus::IsEnabled())
+      StepCensus::Instance().Record(step);
+    if (TruthRecorder::IsEnabled())
+    {
+      auto &truth = TruthRecorder::Instance();
+      if (truth.IsRecording())
+        truth.Record(step);
+    }
+
     // get volume of the current step
     G4LogicalVolume *volume = step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume();
 
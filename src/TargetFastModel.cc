@@ -0,0 +1,202 @@
+/// \file B1/src/TargetFastModel.cc
+/// \brief Implementation of the B1::TargetFastModel class
+
+#include "TargetFastModel.hh"
+
+#include "G4EmCalculator.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Proton.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4VSolid.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+  G4bool TargetFastModel::enabled_ = false;
+
+  namespace
+  {
+    // protons below kMinEnergy stop within a few micrometres, above
+    // kMaxEnergy the generator has none
+    const G4double kMinEnergy = 100 * keV;
+    const G4double kMaxEnergy = 1 * GeV;
+    const G4int kTableBins = 400;
+    // shorter paths, at the surface of the target, are left to the full transport
+    const G4double kMinPath = 1 * nm;
+
+    G4double Beta2(G4double energy, G4double mass)
+    {
+      const G4double gamma = 1. + energy / mass;
+      return 1. - 1. / (gamma * gamma);
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  TargetFastModel::TargetFastModel(const G4String &name, G4Region *envelope)
+      : G4VFastSimulationModel(name, envelope)
+  {
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool TargetFastModel::IsApplicable(const G4ParticleDefinition &particle)
+  {
+    return &particle == G4Proton::ProtonDefinition();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool TargetFastModel::ModelTrigger(const G4FastTrack &fastTrack)
+  {
+    // the physics tables of the calculator are ready once tracking starts
+    if (!material_)
+      BuildTables(fastTrack.GetEnvelopeLogicalVolume()->GetMaterial());
+
+    const G4double energy = fastTrack.GetPrimaryTrack()->GetKineticEnergy();
+    if (energy < kMinEnergy || energy > kMaxEnergy)
+      return false;
+    const G4double length = fastTrack.GetEnvelopeSolid()->DistanceToOut(fastTrack.GetPrimaryTrackLocalPosition(),
+                                                                         fastTrack.GetPrimaryTrackLocalDirection());
+    return length > kMinPath;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TargetFastModel::DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep)
+  {
+    const G4Track *track = fastTrack.GetPrimaryTrack();
+    const G4double energy = track->GetKineticEnergy();
+    const G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+    const G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+    G4double length = fastTrack.GetEnvelopeSolid()->DistanceToOut(position, direction);
+
+    const G4double range = Range(energy);
+    G4double exitEnergy = 0.;
+    if (range > length)
+    {
+      const G4double meanLoss = energy - EnergyAtRange(range - length);
+      const G4double loss = G4RandGauss::shoot(meanLoss, std::sqrt(StragglingRate(energy) * length));
+      exitEnergy = energy - std::max(loss, 0.);
+    }
+
+    // stops in the target
+    if (exitEnergy < kMinEnergy)
+    {
+      length = std::min(range, length);
+      fastStep.KillPrimaryTrack();
+      fastStep.ProposePrimaryTrackFinalPosition(position + length * direction);
+      fastStep.ProposePrimaryTrackPathLength(length);
+      fastStep.ProposeTotalEnergyDeposited(energy);
+      return;
+    }
+
+    // projected angles in the frame of the direction
+    const G4double theta0 = ScatteringWidth(0.5 * (energy + exitEnergy), length);
+    G4ThreeVector exitDirection(std::tan(G4RandGauss::shoot(0., theta0)), std::tan(G4RandGauss::shoot(0., theta0)),
+                                1.);
+    exitDirection = exitDirection.unit();
+    exitDirection.rotateUz(direction);
+
+    const G4double beta =
+        0.5 * (std::sqrt(Beta2(energy, proton_mass_)) + std::sqrt(Beta2(exitEnergy, proton_mass_)));
+    fastStep.ProposePrimaryTrackFinalPosition(position + length * direction);
+    fastStep.ProposePrimaryTrackFinalMomentumDirection(exitDirection);
+    fastStep.ProposePrimaryTrackFinalKineticEnergy(exitEnergy);
+    fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + length / (beta * c_light));
+    fastStep.ProposePrimaryTrackPathLength(length);
+    fastStep.ProposeTotalEnergyDeposited(energy - exitEnergy);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TargetFastModel::BuildTables(const G4Material *material)
+  {
+    material_ = material;
+    const G4ParticleDefinition *proton = G4Proton::ProtonDefinition();
+    proton_mass_ = proton->GetPDGMass();
+    radiation_length_ = material->GetRadlen();
+
+    G4EmCalculator calculator;
+    const G4double twopiMc2Rcl2 = twopi * electron_mass_c2 * classic_electr_radius * classic_electr_radius;
+    const G4double massRatio = electron_mass_c2 / proton_mass_;
+    const G4double logMin = std::log(kMinEnergy);
+    const G4double logStep = (std::log(kMaxEnergy) - logMin) / kTableBins;
+
+    log_energies_.assign(kTableBins + 1, 0.);
+    log_ranges_.assign(kTableBins + 1, 0.);
+    straggling_rates_.assign(kTableBins + 1, 0.);
+    G4double range = 0.;
+    G4double previousEnergy = 0.;
+    G4double previousInverse = 0.;
+    for (G4int i = 0; i <= kTableBins; ++i)
+    {
+      const G4double energy = std::exp(logMin + i * logStep);
+      const G4double inverse = 1. / calculator.ComputeTotalDEDX(energy, proton, material);
+      // below the grid the stopping power rises towards the Bragg peak,
+      // E/S underestimates the residual range by a few tenths of a micrometre
+      range += i == 0 ? energy * inverse : 0.5 * (inverse + previousInverse) * (energy - previousEnergy);
+      log_energies_[i] = logMin + i * logStep;
+      log_ranges_[i] = std::log(range);
+
+      const G4double beta2 = Beta2(energy, proton_mass_);
+      const G4double gamma = 1. + energy / proton_mass_;
+      const G4double tmax = 2. * electron_mass_c2 * beta2 * gamma * gamma /
+                            (1. + 2. * gamma * massRatio + massRatio * massRatio);
+      straggling_rates_[i] = twopiMc2Rcl2 * material->GetElectronDensity() * tmax * (1. / beta2 - 0.5);
+
+      previousEnergy = energy;
+      previousInverse = inverse;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4double TargetFastModel::Range(G4double energy) const
+  {
+    const G4double x = (std::log(energy) - log_energies_.front()) / (log_energies_[1] - log_energies_[0]);
+    const G4int i = std::clamp(static_cast<G4int>(x), 0, kTableBins - 1);
+    return std::exp(log_ranges_[i] + (x - i) * (log_ranges_[i + 1] - log_ranges_[i]));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4double TargetFastModel::EnergyAtRange(G4double range) const
+  {
+    const G4double logRange = std::log(range);
+    const auto upper = std::upper_bound(log_ranges_.begin(), log_ranges_.end(), logRange);
+    const G4int i = std::clamp(static_cast<G4int>(upper - log_ranges_.begin()) - 1, 0, kTableBins - 1);
+    const G4double x = (logRange - log_ranges_[i]) / (log_ranges_[i + 1] - log_ranges_[i]);
+    return std::exp(log_energies_[i] + x * (log_energies_[i + 1] - log_energies_[i]));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4double TargetFastModel::StragglingRate(G4double energy) const
+  {
+    const G4double x = (std::log(energy) - log_energies_.front()) / (log_energies_[1] - log_energies_[0]);
+    const G4int i = std::clamp(static_cast<G4int>(x), 0, kTableBins - 1);
+    return straggling_rates_[i] + (x - i) * (straggling_rates_[i + 1] - straggling_rates_[i]);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4double TargetFastModel::ScatteringWidth(G4double energy, G4double length) const
+  {
+    const G4double beta2 = Beta2(energy, proton_mass_);
+    const G4double pBeta = energy * (energy + 2. * proton_mass_) / (energy + proton_mass_);
+    const G4double thickness = length / radiation_length_;
+    const G4double correction = 1. + 0.038 * std::log(thickness / beta2);
+    return 13.6 * MeV / pBeta * std::sqrt(thickness) * std::max(correction, 0.);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
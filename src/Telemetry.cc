@@ -0,0 +1,248 @@
+/// \file B1/src/Telemetry.cc
+/// \brief Implementation of the B1::Telemetry class
+
+#include "Telemetry.hh"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace B1
+{
+
+  G4bool Telemetry::enabled_ = false;
+
+  namespace
+  {
+    using Clock = std::chrono::steady_clock;
+
+    /// Counters of one worker, on their own cache line
+    struct alignas(64) WorkerSlot
+    {
+      std::atomic<uint64_t> events{0};
+      std::atomic<uint64_t> hits{0};
+      std::atomic<uint64_t> bufferedBytes{0};
+      std::atomic<int64_t> lastEventNs{0};
+    };
+
+    /// Buffered output above which a worker is reported
+    const uint64_t kBufferWarningBytes = 1ull << 30;
+
+    std::array<WorkerSlot, Telemetry::kMaxWorkers> slots;
+    std::atomic<int> nWorkers{0};
+
+    std::string destination;
+    double interval = 10.;
+
+    std::thread sampler;
+    std::mutex samplerMutex;
+    std::condition_variable samplerWakeup;
+    bool stopRequested = false;
+
+    uint64_t eventsToProcess = 0;
+    Clock::time_point runStart;
+
+    int64_t NowNs()
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    double ResidentMB()
+    {
+      std::ifstream statm("/proc/self/statm");
+      long pages = 0, resident = 0;
+      statm >> pages >> resident;
+      return resident * (sysconf(_SC_PAGESIZE) / 1048576.);
+    }
+
+    void Send(const std::string &line)
+    {
+      if (destination.rfind("unix:", 0) == 0)
+      {
+        const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0)
+          return;
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, destination.c_str() + 5, sizeof(addr.sun_path) - 1);
+        // nobody listening is not an error for the run
+        sendto(fd, line.data(), line.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        close(fd);
+      }
+      else
+      {
+        std::ofstream fout(destination, std::ios::app);
+        fout << line << '\n';
+      }
+    }
+
+    /// Events per worker at the previous sample, for the interval rates
+    std::vector<uint64_t> previousEvents;
+    Clock::time_point previousSample;
+
+    void Sample(bool final)
+    {
+      const auto now = Clock::now();
+      const int64_t nowNs = NowNs();
+      const double elapsed = std::chrono::duration<double>(now - runStart).count();
+      const double sinceLast = std::chrono::duration<double>(now - previousSample).count();
+      const int workers = std::min(nWorkers.load(std::memory_order_relaxed), Telemetry::kMaxWorkers);
+      previousEvents.resize(workers, 0);
+
+      struct WorkerSample
+      {
+        uint64_t events, hits, bufferedBytes;
+        double rate, idle;
+      };
+      std::vector<WorkerSample> samples(workers);
+      uint64_t events = 0, hits = 0, buffered = 0;
+      for (int i = 0; i < workers; ++i)
+      {
+        auto &sample = samples[i];
+        sample.events = slots[i].events.load(std::memory_order_relaxed);
+        sample.hits = slots[i].hits.load(std::memory_order_relaxed);
+        sample.bufferedBytes = slots[i].bufferedBytes.load(std::memory_order_relaxed);
+        const int64_t lastEventNs = slots[i].lastEventNs.load(std::memory_order_relaxed);
+        sample.idle = lastEventNs ? (nowNs - lastEventNs) * 1e-9 : elapsed;
+        sample.rate = sinceLast > 0 ? (sample.events - std::min(sample.events, previousEvents[i])) / sinceLast : 0.;
+        previousEvents[i] = sample.events;
+        events += sample.events;
+        hits += sample.hits;
+        buffered += sample.bufferedBytes;
+      }
+
+      double rate = 0.;
+      for (const auto &sample : samples)
+        rate += sample.rate;
+      const double meanRate = workers ? rate / workers : 0.;
+
+      std::ostringstream workerJson, warnings;
+      for (int i = 0; i < workers; ++i)
+      {
+        const auto &sample = samples[i];
+        workerJson << (i ? "," : "") << "{\"id\":" << i << ",\"events\":" << sample.events
+                   << ",\"hits\":" << sample.hits << ",\"bufferedMB\":" << sample.bufferedBytes / 1048576.
+                   << ",\"rate\":" << sample.rate << ",\"idle\":" << sample.idle << "}";
+
+        if (sample.bufferedBytes > kBufferWarningBytes)
+          warnings << "\"worker " << i << " buffers " << sample.bufferedBytes / 1048576 << " MB\",";
+        if (final || events >= eventsToProcess)
+          continue;
+        // no event for several intervals while events remain
+        if (sample.idle > std::max(3 * interval, 30.))
+          warnings << "\"worker " << i << " stuck for " << static_cast<long>(sample.idle) << " s\",";
+        // well below the mean rate of the interval
+        else if (workers > 1 && sample.rate < 0.5 * meanRate)
+          warnings << "\"worker " << i << " slow: " << sample.rate << " events/s, mean " << meanRate << "\",";
+      }
+      previousSample = now;
+
+      const double avgRate = elapsed > 0 ? events / elapsed : 0.;
+      const double eta = avgRate > 0 && events < eventsToProcess ? (eventsToProcess - events) / avgRate : 0.;
+      std::string warningList = warnings.str();
+      if (!warningList.empty())
+        warningList.pop_back();
+
+      std::ostringstream line;
+      line << "{\"time\":" << std::time(nullptr) << ",\"elapsed\":" << elapsed << ",\"final\":"
+           << (final ? "true" : "false") << ",\"events\":" << events << ",\"target\":" << eventsToProcess
+           << ",\"hits\":" << hits << ",\"rate\":" << rate << ",\"avgRate\":" << avgRate << ",\"eta\":" << eta
+           << ",\"rssMB\":" << ResidentMB() << ",\"bufferedMB\":" << buffered / 1048576.
+           << ",\"workers\":[" << workerJson.str() << "],\"warnings\":[" << warningList << "]}";
+      Send(line.str());
+      if (!warningList.empty())
+        std::cerr << "Telemetry warning: [" << warningList << "]" << std::endl;
+    }
+
+    void SamplerLoop()
+    {
+      std::unique_lock<std::mutex> lock(samplerMutex);
+      while (!samplerWakeup.wait_for(lock, std::chrono::duration<double>(interval), [] { return stopRequested; }))
+      {
+        Sample(false);
+      }
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Telemetry::Configure(const std::string &dest, G4double intervalSeconds)
+  {
+    destination = dest;
+    interval = intervalSeconds > 0 ? intervalSeconds : 10.;
+    enabled_ = !destination.empty();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Telemetry::Publish(G4int workerId, uint64_t events, uint64_t hits, uint64_t bufferedBytes)
+  {
+    if (workerId < 0 || workerId >= kMaxWorkers)
+      return;
+    WorkerSlot &slot = slots[workerId];
+    slot.events.store(events, std::memory_order_relaxed);
+    slot.hits.store(hits, std::memory_order_relaxed);
+    slot.bufferedBytes.store(bufferedBytes, std::memory_order_relaxed);
+    slot.lastEventNs.store(NowNs(), std::memory_order_relaxed);
+
+    int known = nWorkers.load(std::memory_order_relaxed);
+    while (known <= workerId && !nWorkers.compare_exchange_weak(known, workerId + 1, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Telemetry::StartRun(uint64_t nEvents)
+  {
+    if (!enabled_)
+      return;
+    StopRun();
+    for (auto &slot : slots)
+    {
+      slot.events.store(0, std::memory_order_relaxed);
+      slot.hits.store(0, std::memory_order_relaxed);
+      slot.bufferedBytes.store(0, std::memory_order_relaxed);
+      slot.lastEventNs.store(0, std::memory_order_relaxed);
+    }
+    nWorkers.store(0, std::memory_order_relaxed);
+    previousEvents.clear();
+    eventsToProcess = nEvents;
+    runStart = previousSample = Clock::now();
+    stopRequested = false;
+    sampler = std::thread(SamplerLoop);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void Telemetry::StopRun()
+  {
+    if (!sampler.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(samplerMutex);
+      stopRequested = true;
+    }
+    samplerWakeup.notify_one();
+    sampler.join();
+    Sample(true);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
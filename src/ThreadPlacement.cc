@@ -0,0 +1,187 @@
+/// \file B1/src/ThreadPlacement.cc
+/// \brief Implementation of the B1::ThreadPlacement class
+
+#include "ThreadPlacement.hh"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace B1
+{
+
+  std::vector<G4int> ThreadPlacement::cpus_;
+  std::vector<G4int> ThreadPlacement::nodes_;
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::vector<G4int> ThreadPlacement::ParseCpuList(const std::string &list)
+  {
+    std::vector<G4int> cpus;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ','))
+    {
+      if (item.empty())
+        continue;
+      char *end = nullptr;
+      const long first = std::strtol(item.c_str(), &end, 10);
+      long last = first;
+      if (*end == '-')
+        last = std::strtol(end + 1, &end, 10);
+      if (*end != '\0' && *end != '\n')
+        return {};
+      if (first < 0 || last < first || last >= CPU_SETSIZE)
+        return {};
+      for (long cpu = first; cpu <= last; ++cpu)
+        cpus.push_back(static_cast<G4int>(cpu));
+    }
+    return cpus;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::vector<std::vector<G4int>> ThreadPlacement::ReadNodes()
+  {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+      for (G4int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        CPU_SET(cpu, &allowed);
+    }
+    auto isAllowed = [&](G4int cpu) { return CPU_ISSET(cpu, &allowed); };
+
+    std::vector<std::pair<G4int, std::vector<G4int>>> nodes;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator("/sys/devices/system/node", ec))
+    {
+      const std::string name = entry.path().filename().string();
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          name.find_first_not_of("0123456789", 4) != std::string::npos)
+        continue;
+      std::ifstream fin(entry.path() / "cpulist");
+      std::string list;
+      std::getline(fin, list);
+      auto cpus = ParseCpuList(list);
+      cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&](G4int cpu) { return !isAllowed(cpu); }),
+                 cpus.end());
+      if (!cpus.empty())
+        nodes.emplace_back(std::atoi(name.c_str() + 4), std::move(cpus));
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    std::vector<std::vector<G4int>> result;
+    for (auto &node : nodes)
+      result.push_back(std::move(node.second));
+    // without NUMA information all allowed CPUs form one node
+    if (result.empty())
+    {
+      result.emplace_back();
+      for (G4int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      {
+        if (isAllowed(cpu))
+          result.back().push_back(cpu);
+      }
+    }
+    return result;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  G4bool ThreadPlacement::Configure(const std::string &layout)
+  {
+    cpus_.clear();
+    nodes_.clear();
+    if (layout.empty() || layout == "none")
+      return true;
+
+    const auto nodes = ReadNodes();
+    if (layout == "compact")
+    {
+      for (std::size_t node = 0; node < nodes.size(); ++node)
+      {
+        for (G4int cpu : nodes[node])
+        {
+          cpus_.push_back(cpu);
+          nodes_.push_back(node);
+        }
+      }
+    }
+    else if (layout == "scatter")
+    {
+      for (std::size_t i = 0;; ++i)
+      {
+        G4bool any = false;
+        for (std::size_t node = 0; node < nodes.size(); ++node)
+        {
+          if (i < nodes[node].size())
+          {
+            cpus_.push_back(nodes[node][i]);
+            nodes_.push_back(node);
+            any = true;
+          }
+        }
+        if (!any)
+          break;
+      }
+    }
+    else
+    {
+      cpus_ = ParseCpuList(layout);
+      if (cpus_.empty())
+      {
+        G4cerr << "Invalid pinning layout " << layout << ", expected none, compact, scatter or a CPU list"
+               << G4endl;
+        return false;
+      }
+      for (G4int cpu : cpus_)
+      {
+        G4int cpuNode = -1;
+        for (std::size_t node = 0; node < nodes.size() && cpuNode < 0; ++node)
+        {
+          if (std::find(nodes[node].begin(), nodes[node].end(), cpu) != nodes[node].end())
+            cpuNode = node;
+        }
+        nodes_.push_back(cpuNode);
+      }
+    }
+    G4cout << "Pinning workers to " << cpus_.size() << " CPUs on " << nodes.size() << " NUMA nodes (" << layout
+           << ")" << G4endl;
+    return !cpus_.empty();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void ThreadPlacement::PinWorker(G4int workerId)
+  {
+    if (cpus_.empty() || workerId < 0)
+      return;
+    const std::size_t slot = workerId % cpus_.size();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus_[slot], &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+    {
+      G4cerr << "Cannot pin worker " << workerId << " to CPU " << cpus_[slot] << ": " << std::strerror(rc)
+             << G4endl;
+      return;
+    }
+    G4cout << "Worker " << workerId << " pinned to CPU " << cpus_[slot];
+    if (nodes_[slot] >= 0)
+      G4cout << " on NUMA node " << nodes_[slot];
+    G4cout << G4endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
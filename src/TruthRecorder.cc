@@ -0,0 +1,208 @@
+/// \file B1/src/TruthRecorder.cc
+/// \brief Implementation of the B1::TruthRecorder class
+
+#include "TruthRecorder.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include <parquet/exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace B1
+{
+
+  G4bool TruthRecorder::enabled_ = false;
+  G4bool TruthRecorder::secondaries_ = false;
+  uint64_t TruthRecorder::threshold_ = 0;
+
+  namespace
+  {
+    /// splitmix64 finalizer, uniform over the event IDs
+    uint64_t Hash(uint64_t x)
+    {
+      x += 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+
+    TruthRecorder::Volume VolumeCode(const G4StepPoint *point)
+    {
+      const auto physical = point->GetPhysicalVolume();
+      if (!physical)
+        return TruthRecorder::kWorld;
+      const auto &name = physical->GetLogicalVolume()->GetName();
+      if (name == "SiStrip")
+        return TruthRecorder::kSiStrip;
+      if (name == "CsI")
+        return TruthRecorder::kCsI;
+      if (name == "Si")
+        return TruthRecorder::kFrontSi;
+      return TruthRecorder::kWorld;
+    }
+
+    template <typename Builder, typename T>
+    std::shared_ptr<arrow::Array> MakeArray(const std::vector<T> &values, arrow::MemoryPool *pool)
+    {
+      Builder builder(pool);
+      PARQUET_THROW_NOT_OK(builder.AppendValues(values.data(), values.size()));
+      std::shared_ptr<arrow::Array> array;
+      PARQUET_THROW_NOT_OK(builder.Finish(&array));
+      return array;
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TruthRecorder::Configure(G4double fraction, G4bool secondaries)
+  {
+    if (fraction <= 0.)
+      return;
+    enabled_ = true;
+    secondaries_ = secondaries;
+    threshold_ = fraction >= 1. ? UINT64_MAX : static_cast<uint64_t>(std::ldexp(fraction, 64));
+    G4cout << "Recording the truth tracks of " << std::min(fraction, 1.) * 100. << "% of the events"
+           << (secondaries ? ", with secondaries" : "") << G4endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<arrow::Schema> TruthRecorder::Schema()
+  {
+    arrow::FieldVector fieldVec;
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("workerId", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("eventId", arrow::int64()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("trackId", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("parentId", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("pdg", arrow::int32()));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("kind", arrow::list(arrow::int8())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("volume", arrow::list(arrow::int8())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("copyId", arrow::list(arrow::int16())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("x", arrow::list(arrow::float32())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("y", arrow::list(arrow::float32())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("z", arrow::list(arrow::float32())));
+    fieldVec.emplace_back(std::make_shared<arrow::Field>("eKin", arrow::list(arrow::float32())));
+    return arrow::schema(fieldVec);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  TruthRecorder &TruthRecorder::Instance()
+  {
+    static thread_local TruthRecorder recorder;
+    return recorder;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TruthRecorder::BeginEvent(int64_t eventId)
+  {
+    recording_ = threshold_ == UINT64_MAX || Hash(eventId) < threshold_;
+    event_id_ = eventId;
+    track_id_ = 0;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TruthRecorder::Record(const G4Step *step)
+  {
+    const G4Track *track = step->GetTrack();
+    if (track->GetParentID() != 0 && !secondaries_)
+      return;
+    const G4StepPoint *pre = step->GetPreStepPoint();
+    const G4StepPoint *post = step->GetPostStepPoint();
+
+    // a track is stepped to its end before the next one starts
+    if (track->GetTrackID() != track_id_)
+    {
+      track_id_ = track->GetTrackID();
+      event_ids_.emplace_back(event_id_);
+      track_ids_.emplace_back(track_id_);
+      parent_ids_.emplace_back(track->GetParentID());
+      pdg_codes_.emplace_back(track->GetParticleDefinition()->GetPDGEncoding());
+      offsets_.emplace_back(offsets_.back());
+      AddPoint(kStart, VolumeCode(pre), pre->GetTouchableHandle()->GetVolume()->GetCopyNo(), pre->GetPosition(),
+               pre->GetKineticEnergy());
+    }
+
+    const Volume volume = VolumeCode(pre);
+    if (volume != kWorld)
+    {
+      const G4int copyId = pre->GetTouchableHandle()->GetVolume()->GetCopyNo();
+      if (pre->GetStepStatus() == fGeomBoundary)
+        AddPoint(kEntry, volume, copyId, pre->GetPosition(), pre->GetKineticEnergy());
+      if (post->GetStepStatus() == fGeomBoundary)
+        AddPoint(kExit, volume, copyId, post->GetPosition(), post->GetKineticEnergy());
+    }
+    if (track->GetTrackStatus() == fStopAndKill || track->GetTrackStatus() == fKillTrackAndSecondaries ||
+        post->GetStepStatus() == fWorldBoundary)
+    {
+      AddPoint(kStop, volume, 0, post->GetPosition(), post->GetKineticEnergy());
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void TruthRecorder::AddPoint(Kind kind, Volume volume, G4int copyId, const G4ThreeVector &position, G4double eKin)
+  {
+    kinds_.emplace_back(kind);
+    volumes_.emplace_back(volume);
+    copy_ids_.emplace_back(static_cast<int16_t>(copyId));
+    x_.emplace_back(static_cast<float>(position.x() / mm));
+    y_.emplace_back(static_cast<float>(position.y() / mm));
+    z_.emplace_back(static_cast<float>(position.z() / mm));
+    e_kin_.emplace_back(static_cast<float>(eKin / MeV));
+    ++offsets_.back();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<arrow::Table> TruthRecorder::Finish(G4int workerId, arrow::MemoryPool *pool)
+  {
+    const auto offsets = MakeArray<arrow::Int32Builder>(offsets_, pool);
+    const auto makeList = [&offsets, pool](const std::shared_ptr<arrow::Array> &values)
+    {
+      std::shared_ptr<arrow::ListArray> list;
+      PARQUET_ASSIGN_OR_THROW(list, arrow::ListArray::FromArrays(*offsets, *values, pool));
+      return std::static_pointer_cast<arrow::Array>(list);
+    };
+    const std::vector<int32_t> workerIds(track_ids_.size(), workerId);
+    arrow::ArrayVector arrayVec = {
+        MakeArray<arrow::Int32Builder>(workerIds, pool),
+        MakeArray<arrow::Int64Builder>(event_ids_, pool),
+        MakeArray<arrow::Int32Builder>(track_ids_, pool),
+        MakeArray<arrow::Int32Builder>(parent_ids_, pool),
+        MakeArray<arrow::Int32Builder>(pdg_codes_, pool),
+        makeList(MakeArray<arrow::Int8Builder>(kinds_, pool)),
+        makeList(MakeArray<arrow::Int8Builder>(volumes_, pool)),
+        makeList(MakeArray<arrow::Int16Builder>(copy_ids_, pool)),
+        makeList(MakeArray<arrow::FloatBuilder>(x_, pool)),
+        makeList(MakeArray<arrow::FloatBuilder>(y_, pool)),
+        makeList(MakeArray<arrow::FloatBuilder>(z_, pool)),
+        makeList(MakeArray<arrow::FloatBuilder>(e_kin_, pool))};
+
+    // keep the capacity of the arena
+    event_ids_.clear();
+    track_ids_.clear();
+    parent_ids_.clear();
+    pdg_codes_.clear();
+    offsets_.assign(1, 0);
+    kinds_.clear();
+    volumes_.clear();
+    copy_ids_.clear();
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    e_kin_.clear();
+    return arrow::Table::Make(Schema(), arrayVec);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,22 @@
+/// \file B1/src/WorkerInitialization.cc
+/// \brief Implementation of the B1::WorkerInitialization class
+
+#include "WorkerInitialization.hh"
+#include "ThreadPlacement.hh"
+
+#include "G4Threading.hh"
+
+namespace B1
+{
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerInitialization::WorkerInitialize() const
+  {
+    if (ThreadPlacement::IsEnabled())
+      ThreadPlacement::PinWorker(G4Threading::G4GetThreadId());
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,140 @@
+/// \file B1/src/WorkerMemoryPool.cc
+/// \brief Implementation of the B1::WorkerMemoryPool class
+
+#include "WorkerMemoryPool.hh"
+
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace B1
+{
+
+  namespace
+  {
+    G4Mutex masterMutex = G4MUTEX_INITIALIZER;
+    WorkerMemoryPool::Stats masterStats;
+    G4int masterWorkers = 0;
+    std::string masterBackend;
+
+    arrow::MemoryPool *SelectBackend(G4bool systemAllocator)
+    {
+      arrow::MemoryPool *pool = nullptr;
+      if (!systemAllocator)
+      {
+        if (arrow::mimalloc_memory_pool(&pool).ok() && pool)
+          return pool;
+        if (arrow::jemalloc_memory_pool(&pool).ok() && pool)
+          return pool;
+      }
+      return arrow::system_memory_pool();
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  WorkerMemoryPool::WorkerMemoryPool(G4bool systemAllocator) : backend_(SelectBackend(systemAllocator))
+  {
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  arrow::Status WorkerMemoryPool::Allocate(int64_t size, int64_t alignment, uint8_t **out)
+  {
+    ARROW_RETURN_NOT_OK(backend_->Allocate(size, alignment, out));
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    total_bytes_.fetch_add(size, std::memory_order_relaxed);
+    UpdatePeak(bytes_.fetch_add(size, std::memory_order_relaxed) + size);
+    return arrow::Status::OK();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  arrow::Status WorkerMemoryPool::Reallocate(int64_t oldSize, int64_t newSize, int64_t alignment, uint8_t **ptr)
+  {
+    ARROW_RETURN_NOT_OK(backend_->Reallocate(oldSize, newSize, alignment, ptr));
+    reallocations_.fetch_add(1, std::memory_order_relaxed);
+    reallocated_bytes_.fetch_add(std::min(oldSize, newSize), std::memory_order_relaxed);
+    if (newSize > oldSize)
+      total_bytes_.fetch_add(newSize - oldSize, std::memory_order_relaxed);
+    UpdatePeak(bytes_.fetch_add(newSize - oldSize, std::memory_order_relaxed) + newSize - oldSize);
+    return arrow::Status::OK();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerMemoryPool::Free(uint8_t *buffer, int64_t size, int64_t alignment)
+  {
+    backend_->Free(buffer, size, alignment);
+    bytes_.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerMemoryPool::UpdatePeak(int64_t bytes)
+  {
+    int64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (bytes > peak && !peak_bytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  WorkerMemoryPool::Stats WorkerMemoryPool::GetStats() const
+  {
+    Stats stats;
+    stats.allocations = allocations_.load(std::memory_order_relaxed);
+    stats.reallocations = reallocations_.load(std::memory_order_relaxed);
+    stats.reallocatedBytes = reallocated_bytes_.load(std::memory_order_relaxed);
+    stats.peakBytes = peak_bytes_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerMemoryPool::MergeToMaster()
+  {
+    // frees of streamed batches may still come in from other threads
+    Stats stats;
+    stats.allocations = allocations_.exchange(0, std::memory_order_relaxed);
+    stats.reallocations = reallocations_.exchange(0, std::memory_order_relaxed);
+    stats.reallocatedBytes = reallocated_bytes_.exchange(0, std::memory_order_relaxed);
+    stats.peakBytes = peak_bytes_.exchange(bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    G4AutoLock lock(&masterMutex);
+    masterStats.allocations += stats.allocations;
+    masterStats.reallocations += stats.reallocations;
+    masterStats.reallocatedBytes += stats.reallocatedBytes;
+    // the worker peaks need not coincide, their sum would overstate the job
+    masterStats.peakBytes = std::max(masterStats.peakBytes, stats.peakBytes);
+    ++masterWorkers;
+    masterBackend = backend_name();
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerMemoryPool::ResetMaster()
+  {
+    G4AutoLock lock(&masterMutex);
+    masterStats = Stats();
+    masterWorkers = 0;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void WorkerMemoryPool::PrintMaster(std::ostream &os)
+  {
+    G4AutoLock lock(&masterMutex);
+    if (masterWorkers == 0)
+      return;
+    os << " Output memory pools (" << masterWorkers << " workers, " << masterBackend << "):" << std::endl
+       << "  peak " << std::setprecision(4) << masterStats.peakBytes / 1048576. << " MiB largest worker, "
+       << masterStats.allocations << " allocations, " << masterStats.reallocations << " reallocations moving up to "
+       << masterStats.reallocatedBytes / 1048576. << " MiB" << std::endl;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
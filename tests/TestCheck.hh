@@ -0,0 +1,43 @@
+/// \file TestCheck.hh
+/// \brief Minimal checks of the unit tests, without a test framework
+///
+/// A failed CHECK prints its expression and location and the test goes on;
+/// main returns test::Result(), non-zero if any check failed, for ctest.
+
+#ifndef TestCheck_h
+#define TestCheck_h 1
+
+#include <cmath>
+#include <iostream>
+
+namespace test
+{
+
+  inline int &Failures()
+  {
+    static int failures = 0;
+    return failures;
+  }
+
+  inline void Check(bool condition, const char *expression, const char *file, int line)
+  {
+    if (condition)
+      return;
+    ++Failures();
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+  }
+
+  inline int Result()
+  {
+    if (Failures() > 0)
+      std::cerr << Failures() << " checks failed" << std::endl;
+    return Failures() > 0 ? 1 : 0;
+  }
+
+}
+
+#define CHECK(condition) test::Check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_NEAR(value, expected, tolerance)                                                             \
+  test::Check(std::abs((value) - (expected)) <= (tolerance), #value " == " #expected, __FILE__, __LINE__)
+
+#endif
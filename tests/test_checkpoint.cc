@@ -0,0 +1,108 @@
+/// \file test_checkpoint.cc
+/// \brief Completed event ranges and manifests of B1::CheckpointManager
+
+#include "CheckpointManager.hh"
+
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+#include "TestCheck.hh"
+
+using namespace B1;
+
+namespace
+{
+  using Ranges = std::vector<CheckpointManager::EventRange>;
+
+  void TestAddToRanges()
+  {
+    Ranges ranges;
+    CheckpointManager::AddToRanges(ranges, 5);
+    CHECK(ranges == Ranges({{5, 5}}));
+    CheckpointManager::AddToRanges(ranges, 6);
+    CheckpointManager::AddToRanges(ranges, 7);
+    CHECK(ranges == Ranges({{5, 7}}));
+    // a gap starts a new range
+    CheckpointManager::AddToRanges(ranges, 9);
+    CHECK(ranges == Ranges({{5, 7}, {9, 9}}));
+    // an ID out of order is merged into place
+    CheckpointManager::AddToRanges(ranges, 2);
+    CHECK(ranges == Ranges({{2, 2}, {5, 7}, {9, 9}}));
+    CheckpointManager::AddToRanges(ranges, 8);
+    CHECK(ranges == Ranges({{2, 2}, {5, 9}}));
+    CheckpointManager::AddToRanges(ranges, 6);
+    CHECK(ranges == Ranges({{2, 2}, {5, 9}}));
+
+    Ranges unsorted = {{50, 54}, {20, 29}, {30, 31}, {10, 12}, {11, 15}, {60, 60}};
+    CheckpointManager::MergeRanges(unsorted);
+    CHECK(unsorted == Ranges({{10, 15}, {20, 31}, {50, 54}, {60, 60}}));
+  }
+
+  void TestResume(const std::string &prefix)
+  {
+    auto &checkpoint = CheckpointManager::Instance();
+
+    // first attempt of run 0, interrupted
+    checkpoint.Configure(10, false);
+    CHECK(checkpoint.BeginRun(prefix, 0, 100));
+    checkpoint.Commit(0, 1, 10, {{0, 9}});
+    checkpoint.Commit(1, 1, 5, {{50, 54}});
+    checkpoint.Commit(0, 2, 20, {{10, 19}});
+    // run 1, completed
+    CHECK(checkpoint.BeginRun(prefix, 1, 20));
+    checkpoint.Commit(0, 1, 20, {{0, 19}});
+    checkpoint.EndRun();
+
+    checkpoint.Configure(10, true);
+    CHECK(checkpoint.IsResuming());
+    CHECK(checkpoint.BeginRun(prefix, 0, 100));
+    const auto state = checkpoint.GetWorkerState(0);
+    CHECK(state.parts == 2);
+    CHECK(state.cursor == 20);
+    CHECK(state.completed == Ranges({{0, 19}}));
+    CHECK(checkpoint.GetWorkerState(2).parts == 0);
+    CHECK(checkpoint.IsCompleted(0));
+    CHECK(checkpoint.IsCompleted(19));
+    CHECK(!checkpoint.IsCompleted(20));
+    CHECK(!checkpoint.IsCompleted(49));
+    CHECK(checkpoint.IsCompleted(50));
+    CHECK(checkpoint.IsCompleted(54));
+    CHECK(!checkpoint.IsCompleted(55));
+
+    // the resumed attempt hands worker 1 events below the ones it completed
+    checkpoint.Commit(1, 2, 10, {{20, 29}});
+    CHECK(checkpoint.GetWorkerState(1).completed == Ranges({{20, 29}, {50, 54}}));
+    checkpoint.Commit(1, 3, 15, {{30, 34}, {55, 55}});
+    CHECK(checkpoint.GetWorkerState(1).completed == Ranges({{20, 34}, {50, 55}}));
+
+    // a second interruption resumes from all of them
+    CHECK(checkpoint.BeginRun(prefix, 0, 100));
+    CHECK(checkpoint.GetWorkerState(1).completed == Ranges({{20, 34}, {50, 55}}));
+    CHECK(checkpoint.IsCompleted(25));
+    CHECK(checkpoint.IsCompleted(34));
+    CHECK(!checkpoint.IsCompleted(35));
+    CHECK(checkpoint.IsCompleted(55));
+
+    // a completed run is skipped entirely
+    CHECK(checkpoint.BeginRun(prefix, 1, 20));
+    CHECK(checkpoint.IsCompleted(0));
+    CHECK(checkpoint.IsCompleted(1000));
+
+    // a run the first attempt did not reach starts from scratch
+    CHECK(checkpoint.BeginRun(prefix, 2, 100));
+    CHECK(!checkpoint.IsCompleted(0));
+    CHECK(checkpoint.GetWorkerState(0).parts == 0);
+  }
+}
+
+int main()
+{
+  TestAddToRanges();
+
+  const std::string prefix =
+      (std::filesystem::temp_directory_path() / ("octupole_test_checkpoint" + std::to_string(getpid()))).string();
+  TestResume(prefix);
+  std::filesystem::remove_all(prefix);
+  return test::Result();
+}
@@ -0,0 +1,67 @@
+/// \file test_dataset_files.cc
+/// \brief Output table files and event keys shared by the tools
+
+#include "DatasetFiles.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <unordered_set>
+
+#include "TestCheck.hh"
+
+namespace
+{
+  void TestDatasetFiles()
+  {
+    CHECK(tables::RunPartition("out/eDep/run=3/worker0.parquet") == "run=3");
+    CHECK(tables::RunPartition("out/eDep/worker0.parquet").empty());
+    CHECK(tables::RunId("out/eDep/run=12/worker0.parquet") == 12);
+    CHECK(tables::RunId("out/eDep/worker0.parquet") == -1);
+    CHECK(tables::TableDir("out/eDep/run=3/worker0.parquet") == "out/eDep");
+    CHECK(tables::TableDir("out/eDep/worker0.parquet") == "out/eDep");
+    CHECK(tables::InTable("out/shard0of2/evtInfo/run=0/worker_1_part2.parquet", "evtInfo"));
+    CHECK(!tables::InTable("out/evtInfo/run=0/worker_1.txt", "evtInfo"));
+    CHECK(!tables::InTable("out/eDep/run=0/worker1.parquet", "evtInfo"));
+
+    // event IDs restart in every run
+    std::unordered_set<tables::EventKey, tables::EventKeyHash> keys = {{0, 5}, {1, 5}, {-1, 5}};
+    CHECK(keys.size() == 3);
+    CHECK(keys.count({1, 5}) == 1);
+    CHECK(keys.count({2, 5}) == 0);
+  }
+
+  void TestFindFiles(const std::filesystem::path &prefix)
+  {
+    for (const char *name : {"shard1of2/eDep/run=0/worker0.parquet", "shard0of2/eDep/run=1/worker0.parquet",
+                             "shard0of2/eDep/run=0/worker1.parquet", "shard0of2/eDep/run=0/worker0.parquet",
+                             "shard0of2/eDep/run=0/notes.txt", "shard0of2/evtInfo/run=0/worker_0.parquet"})
+    {
+      std::filesystem::create_directories((prefix / name).parent_path());
+      std::ofstream(prefix / name);
+    }
+
+    // path order, whatever the directory order
+    const auto files = tables::FindFiles(prefix.string(), "eDep");
+    CHECK(files.size() == 4);
+    if (files.size() != 4)
+      return;
+    CHECK(files[0] == prefix / "shard0of2/eDep/run=0/worker0.parquet");
+    CHECK(files[1] == prefix / "shard0of2/eDep/run=0/worker1.parquet");
+    CHECK(files[2] == prefix / "shard0of2/eDep/run=1/worker0.parquet");
+    CHECK(files[3] == prefix / "shard1of2/eDep/run=0/worker0.parquet");
+    CHECK(tables::FindFiles(prefix.string(), "evtInfo").size() == 1);
+    CHECK(tables::FindFiles(prefix.string(), "overlay").empty());
+  }
+}
+
+int main()
+{
+  TestDatasetFiles();
+
+  const auto prefix = std::filesystem::temp_directory_path() / ("octupole_test_dataset_files" + std::to_string(getpid()));
+  TestFindFiles(prefix);
+  std::filesystem::remove_all(prefix);
+  return test::Result();
+}
@@ -0,0 +1,108 @@
+/// \file test_event_seeder.cc
+/// \brief Global event IDs of the shards and event seeds of B1::EventSeeder
+
+#include "EventSeeder.hh"
+#include "Sharding.hh"
+
+#include "G4Event.hh"
+#include "Randomize.hh"
+
+#include <vector>
+
+#include "TestCheck.hh"
+
+using namespace B1;
+
+namespace
+{
+  std::vector<double> Draw(int n)
+  {
+    std::vector<double> values;
+    for (int i = 0; i < n; ++i)
+      values.push_back(G4Random::getTheEngine()->flat());
+    return values;
+  }
+
+  void TestGlobalEventId()
+  {
+    // without --shard the global ID is the Geant4 event ID
+    G4Event event(42);
+    CHECK(EventSeeder::GlobalEventId(&event) == 42);
+  }
+
+  void TestShardRanges()
+  {
+    // the shards cover the global event IDs of the run once, in order
+    for (const int64_t nTotal : {0, 1, 7, 100, 1001})
+    {
+      for (const int count : {1, 2, 3, 7, 16})
+      {
+        int64_t next = 0;
+        for (int index = 0; index < count; ++index)
+        {
+          const auto range = Sharding::Range(nTotal, index, count);
+          CHECK(range.first == next);
+          CHECK(range.second >= nTotal / count && range.second <= nTotal / count + 1);
+          next = range.first + range.second;
+        }
+        CHECK(next == nTotal);
+      }
+    }
+  }
+
+  void TestEventSeeds()
+  {
+    long seeds[3] = {12345, 67890, 0};
+    G4Random::setTheSeeds(seeds);
+    EventSeeder::BeginRun(0);
+
+    // same event, same stream, whatever was drawn before
+    EventSeeder::SeedEvent(7);
+    const auto first = Draw(4);
+    Draw(100);
+    EventSeeder::SeedEvent(7);
+    CHECK(Draw(4) == first);
+
+    EventSeeder::SeedEvent(8);
+    CHECK(Draw(4) != first);
+  }
+
+  void TestBaseSeed()
+  {
+    long seeds[3] = {12345, 67890, 0};
+    G4Random::setTheSeeds(seeds);
+    EventSeeder::BeginRun(0);
+    const uint64_t run0 = EventSeeder::GetBaseSeed();
+    Draw(1000);
+    EventSeeder::EndRun();
+    EventSeeder::BeginRun(1);
+    const uint64_t run1 = EventSeeder::GetBaseSeed();
+    CHECK(run1 != run0);
+
+    // another shard: same seeds, fewer events in run 0, same base seeds
+    G4Random::setTheSeeds(seeds);
+    EventSeeder::BeginRun(0);
+    CHECK(EventSeeder::GetBaseSeed() == run0);
+    Draw(10);
+    EventSeeder::EndRun();
+    EventSeeder::BeginRun(1);
+    CHECK(EventSeeder::GetBaseSeed() == run1);
+    EventSeeder::EndRun();
+
+    // /random/setSeeds between the runs selects another sequence, also when
+    // it changes only the second seed
+    long otherSeeds[3] = {12345, 9876, 0};
+    G4Random::setTheSeeds(otherSeeds);
+    EventSeeder::BeginRun(1);
+    CHECK(EventSeeder::GetBaseSeed() != run1);
+  }
+}
+
+int main()
+{
+  TestGlobalEventId();
+  TestShardRanges();
+  TestEventSeeds();
+  TestBaseSeed();
+  return test::Result();
+}
@@ -0,0 +1,95 @@
+/// \file test_reconstruction.cc
+/// \brief Strip clustering and dE-E pairing of B1::Reconstruction
+
+#include "Reconstruction.hh"
+#include "ExpConstants.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include "TestCheck.hh"
+
+using namespace B1;
+
+namespace
+{
+  const G4double kStripWidth = kSiSize / kNSiStrips;
+
+  void TestEmpty()
+  {
+    std::vector<RecoHit> hits(1);
+    Reconstruction::Reconstruct({}, 1. * MeV, {{0, 5. * MeV}}, hits);
+    CHECK(hits.empty());
+
+    // strips below threshold form no cluster
+    Reconstruction::Reconstruct({{3, 0.01 * MeV}, {4, 0.02 * MeV}}, 1. * MeV, {}, hits);
+    CHECK(hits.empty());
+  }
+
+  void TestClusters()
+  {
+    // 10-11 adjacent, 12 below threshold splits 13 off, 100 alone
+    const std::map<int, double> strips = {
+        {10, 1. * MeV}, {11, 3. * MeV}, {12, 0.01 * MeV}, {13, 0.5 * MeV}, {100, 2. * MeV}};
+    std::vector<RecoHit> hits;
+    Reconstruction::Reconstruct(strips, 0.2 * MeV, {}, hits);
+    CHECK(hits.size() == 3);
+    if (hits.size() != 3)
+      return;
+
+    CHECK(hits[0].firstStrip == 10);
+    CHECK(hits[0].nStrips == 2);
+    CHECK_NEAR(hits[0].eStrips, 4. * MeV, 1e-12);
+    CHECK_NEAR(hits[0].centroid, (10. * 1. + 11. * 3.) / 4., 1e-12);
+    CHECK_NEAR(hits[0].y, kSiYOffset + hits[0].centroid * kStripWidth, 1e-9);
+
+    CHECK(hits[1].firstStrip == 13);
+    CHECK(hits[1].nStrips == 1);
+    CHECK_NEAR(hits[1].centroid, 13., 1e-12);
+
+    CHECK(hits[2].firstStrip == 100);
+    CHECK_NEAR(hits[2].eStrips, 2. * MeV, 1e-12);
+
+    for (const auto &hit : hits)
+    {
+      CHECK(hit.multiplicity == 3);
+      CHECK_NEAR(hit.eFront, 0.2 * MeV, 1e-12);
+      CHECK(hit.csiId == -1);
+      CHECK(hit.eCsI == 0.);
+    }
+  }
+
+  void TestPairing()
+  {
+    // strip 10 is below the middle of the plane (crystals 2, 3), strip 100
+    // above it (crystals 0, 1)
+    const std::map<int, double> strips = {{10, 1. * MeV}, {100, 2. * MeV}};
+    const std::map<int, double> csi = {{0, 5. * MeV}, {1, 0.3 * MeV}, {2, 7. * MeV}, {3, 8. * MeV}};
+    std::vector<RecoHit> hits;
+    Reconstruction::Reconstruct(strips, 0.02 * MeV, csi, hits);
+    CHECK(hits.size() == 2);
+    if (hits.size() != 2)
+      return;
+
+    // most energetic crystal of the half
+    CHECK(hits[0].csiId == 3);
+    CHECK_NEAR(hits[0].eCsI, 8. * MeV, 1e-12);
+    CHECK(hits[1].csiId == 0);
+    CHECK_NEAR(hits[1].eCsI, 5. * MeV, 1e-12);
+
+    // front Si below threshold
+    CHECK(hits[0].eFront == 0.);
+    CHECK_NEAR(hits[1].ETotal(), 2. * MeV + 5. * MeV, 1e-12);
+
+    // crystal 1 alone is below threshold
+    Reconstruction::Reconstruct({{100, 2. * MeV}}, 0., {{1, 0.3 * MeV}}, hits);
+    CHECK(hits.size() == 1 && hits[0].csiId == -1);
+  }
+}
+
+int main()
+{
+  TestEmpty();
+  TestClusters();
+  TestPairing();
+  return test::Result();
+}
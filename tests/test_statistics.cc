@@ -0,0 +1,88 @@
+/// \file test_statistics.cc
+/// \brief Two-sample statistics shared by the tools
+
+#include "Statistics.hh"
+
+#include <limits>
+
+#include "TestCheck.hh"
+
+namespace
+{
+  void TestMoments()
+  {
+    CHECK(stats::Mean({}) == 0.);
+    CHECK_NEAR(stats::Mean({1., 2., 3., 6.}), 3., 1e-12);
+    CHECK(stats::Rms({4.}) == 0.);
+    CHECK_NEAR(stats::Rms({1., 2., 3., 6.}), std::sqrt(14. / 3.), 1e-12);
+    CHECK(stats::RelativeShift(0., 0.) == 0.);
+    CHECK(stats::RelativeShift(0., 1.) == 1.);
+    CHECK_NEAR(stats::RelativeShift(-2., -2.5), 0.25, 1e-12);
+  }
+
+  void TestKolmogorov()
+  {
+    const std::vector<double> a = {1., 2., 3., 4.};
+    CHECK(stats::KolmogorovDistance(a, a) == 0.);
+    CHECK(stats::KolmogorovDistance(a, {}) == 1.);
+    CHECK(stats::KolmogorovDistance({1., 2.}, {3., 4.}) == 1.);
+    // F_a(2) = 1/2, F_b(2) = 0
+    CHECK_NEAR(stats::KolmogorovDistance(a, {2.5, 3., 4., 5.}), 0.5, 1e-12);
+    // ties step both distributions together
+    CHECK(stats::KolmogorovDistance({1., 1., 2.}, {1., 1., 2.}) == 0.);
+
+    CHECK(stats::KolmogorovProbability(0., 100., 100.) == 1.);
+    const double p = stats::KolmogorovProbability(0.2, 100., 100.);
+    CHECK(p > 0.02 && p < 0.06);
+    CHECK(stats::KolmogorovProbability(1., 100., 100.) < 1e-12);
+  }
+
+  void TestChi2()
+  {
+    // Q(1, x) = exp(-x), chi2 with 2 degrees of freedom
+    CHECK_NEAR(stats::GammaQ(1., 0.5), std::exp(-0.5), 1e-12);
+    CHECK_NEAR(stats::GammaQ(1., 5.), std::exp(-5.), 1e-12);
+    CHECK_NEAR(stats::Chi2Probability(2., 2), std::exp(-1.), 1e-12);
+    CHECK_NEAR(stats::Chi2Probability(3.841458820694124, 1), 0.05, 1e-9);
+    CHECK(stats::Chi2Probability(5., 0) == 1.);
+
+    std::vector<double> ha, hb;
+    stats::FillHistograms({0., 1., 2., 2.5}, {0., 1., 2., 4.}, 4, ha, hb);
+    CHECK(ha == std::vector<double>({1., 1., 2., 0.}));
+    CHECK(hb == std::vector<double>({1., 1., 1., 1.}));
+
+    double chi2;
+    int ndf;
+    stats::HistogramChi2(ha, ha, chi2, ndf);
+    CHECK(chi2 == 0.);
+    CHECK(ndf == 2);
+    stats::HistogramChi2(ha, hb, chi2, ndf);
+    // (2 - 1)^2 / 3 + (0 - 1)^2 / 1
+    CHECK_NEAR(chi2, 1. / 3. + 1., 1e-12);
+    CHECK(ndf == 3);
+    stats::HistogramChi2(ha, std::vector<double>(4, 0.), chi2, ndf);
+    CHECK(ndf == -1);
+  }
+
+  void TestDegenerateHistograms()
+  {
+    std::vector<double> ha, hb;
+    // no spread: everything in the first bin
+    stats::FillHistograms({2., 2.}, {2.}, 10, ha, hb);
+    CHECK(ha.size() == 10 && ha[0] == 2. && hb[0] == 1.);
+    stats::FillHistograms({}, {}, 0, ha, hb);
+    CHECK(ha.size() == 1 && ha[0] == 0.);
+    const double inf = std::numeric_limits<double>::infinity();
+    stats::FillHistograms({0., inf}, {1.}, 4, ha, hb);
+    CHECK(ha[0] == 2. && hb[0] == 1.);
+  }
+}
+
+int main()
+{
+  TestMoments();
+  TestKolmogorov();
+  TestChi2();
+  TestDegenerateHistograms();
+  return test::Result();
+}
@@ -0,0 +1,146 @@
+/// \file DatasetFiles.hh
+/// \brief Files of the output tables below a dataset prefix, shared by the tools
+///
+/// exampleB1 writes <prefix>/<table>/run=<ID>/<file>.parquet; older datasets
+/// and the tool outputs have the files directly in <prefix>/<table>. A
+/// sharded dataset has the table directories of its shards below the prefix.
+/// Event IDs are unique within a run only (see EventSeeder), so events are
+/// keyed by run and event ID. The files are listed in path order, so that the
+/// order of the events read does not depend on the directory order.
+
+#ifndef ToolsDatasetFiles_h
+#define ToolsDatasetFiles_h 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/exception.h>
+
+namespace tables
+{
+
+  /// Run partition directory of the file ("run=<ID>"), empty if the file is
+  /// directly in its table directory
+  inline std::string RunPartition(const std::filesystem::path &path)
+  {
+    const std::string dir = path.parent_path().filename().string();
+    return dir.rfind("run=", 0) == 0 ? dir : std::string();
+  }
+
+  /// Run ID of the partition of the file, -1 outside a partition
+  inline int64_t RunId(const std::filesystem::path &path)
+  {
+    const std::string partition = RunPartition(path);
+    return partition.empty() ? -1 : std::strtoll(partition.c_str() + 4, nullptr, 10);
+  }
+
+  /// Table directory of the file, above its run partition
+  inline std::filesystem::path TableDir(const std::filesystem::path &path)
+  {
+    return RunPartition(path).empty() ? path.parent_path() : path.parent_path().parent_path();
+  }
+
+  /// Whether the file belongs to the table, directly in its directory or in
+  /// a run=<ID> partition of it
+  inline bool InTable(const std::filesystem::path &path, const std::string &table)
+  {
+    return path.extension() == ".parquet" && TableDir(path).filename() == table;
+  }
+
+  /// Files of the table below the prefix, in path order
+  inline std::vector<std::filesystem::path> FindFiles(const std::string &prefix, const std::string &table)
+  {
+    std::vector<std::filesystem::path> files;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(prefix))
+    {
+      if (InTable(entry.path(), table))
+        files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  /// Named columns of a file, all of them if none are named, decoded in
+  /// parallel by the Arrow reader into one chunk per column
+  inline std::shared_ptr<arrow::Table> ReadColumns(const std::filesystem::path &path,
+                                                   const std::vector<std::string> &columns = {})
+  {
+    parquet::ArrowReaderProperties properties;
+    properties.set_use_threads(true);
+    properties.set_pre_buffer(true);
+    parquet::arrow::FileReaderBuilder builder;
+    PARQUET_THROW_NOT_OK(builder.OpenFile(path.string()));
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    PARQUET_THROW_NOT_OK(builder.properties(properties)->Build(&reader));
+    std::shared_ptr<arrow::Table> table;
+    if (columns.empty())
+      PARQUET_THROW_NOT_OK(reader->ReadTable(&table));
+    else
+    {
+      std::shared_ptr<arrow::Schema> schema;
+      PARQUET_THROW_NOT_OK(reader->GetSchema(&schema));
+      std::vector<int> indices;
+      for (const auto &column : columns)
+      {
+        const int index = schema->GetFieldIndex(column);
+        if (index < 0)
+          throw std::runtime_error(path.string() + " has no column " + column);
+        indices.push_back(index);
+      }
+      PARQUET_THROW_NOT_OK(reader->ReadTable(indices, &table));
+    }
+    PARQUET_ASSIGN_OR_THROW(table, table->CombineChunks());
+    return table;
+  }
+
+  /// Table of one file with the run of its partition
+  struct RunTable
+  {
+    int64_t runId;
+    std::shared_ptr<arrow::Table> table;
+  };
+
+  /// Named columns of the non-empty files of the table below the prefix, one
+  /// table per file, in path order
+  inline std::vector<RunTable> ReadTables(const std::string &prefix, const std::string &table,
+                                          const std::vector<std::string> &columns = {})
+  {
+    std::vector<RunTable> runTables;
+    for (const auto &path : FindFiles(prefix, table))
+    {
+      auto result = ReadColumns(path, columns);
+      if (result->num_rows() > 0)
+        runTables.push_back({RunId(path), result});
+    }
+    return runTables;
+  }
+
+  struct EventKey
+  {
+    int64_t runId = -1;
+    int64_t eventId = 0;
+
+    bool operator==(const EventKey &other) const { return runId == other.runId && eventId == other.eventId; }
+  };
+
+  struct EventKeyHash
+  {
+    std::size_t operator()(const EventKey &key) const
+    {
+      return std::hash<int64_t>()(key.eventId) ^ (std::hash<int64_t>()(key.runId) * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+
+}
+
+#endif
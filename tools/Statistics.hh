@@ -0,0 +1,178 @@
+/// \file Statistics.hh
+/// \brief Two-sample statistics shared by compare_edep and validate_output
+///
+/// Header-only, without Arrow, so the tests can use it directly. Spectra are
+/// sorted vectors of values; histograms are vectors of bin contents.
+
+#ifndef ToolsStatistics_h
+#define ToolsStatistics_h 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace stats
+{
+
+  inline double Mean(const std::vector<double> &values)
+  {
+    if (values.empty())
+      return 0;
+    double sum = 0;
+    for (const auto v : values)
+      sum += v;
+    return sum / values.size();
+  }
+
+  /// Standard deviation around the mean
+  inline double Rms(const std::vector<double> &values)
+  {
+    if (values.size() < 2)
+      return 0;
+    const double mean = Mean(values);
+    double sum = 0;
+    for (const auto v : values)
+      sum += (v - mean) * (v - mean);
+    return std::sqrt(sum / (values.size() - 1));
+  }
+
+  /// Relative shift of the test value, 1 for a zero reference
+  inline double RelativeShift(double reference, double test)
+  {
+    if (reference == test)
+      return 0.;
+    return reference != 0. ? std::abs(test - reference) / std::abs(reference) : 1.;
+  }
+
+  /// Largest distance between the two empirical distribution functions of
+  /// the sorted samples, 1 if one is empty
+  inline double KolmogorovDistance(const std::vector<double> &a, const std::vector<double> &b)
+  {
+    if (a.empty() || b.empty())
+      return 1;
+    size_t i = 0, j = 0;
+    double distance = 0;
+    while (i < a.size() && j < b.size())
+    {
+      const double x = std::min(a[i], b[j]);
+      while (i < a.size() && a[i] <= x)
+        ++i;
+      while (j < b.size() && b[j] <= x)
+        ++j;
+      distance = std::max(distance, std::abs(double(i) / a.size() - double(j) / b.size()));
+    }
+    return distance;
+  }
+
+  /// Probability of a larger KS distance for equal distributions
+  inline double KolmogorovProbability(double distance, double na, double nb)
+  {
+    const double ne = std::sqrt(na * nb / (na + nb));
+    const double lambda = (ne + 0.12 + 0.11 / ne) * distance;
+    if (lambda < 0.2)
+      return 1.;
+    double sum = 0., sign = 1.;
+    for (int k = 1; k <= 100; ++k)
+    {
+      const double term = std::exp(-2. * k * k * lambda * lambda);
+      sum += sign * term;
+      if (term < 1e-12)
+        break;
+      sign = -sign;
+    }
+    return std::clamp(2. * sum, 0., 1.);
+  }
+
+  /// Upper regularized incomplete gamma function Q(a, x)
+  inline double GammaQ(double a, double x)
+  {
+    if (x <= 0.)
+      return 1.;
+    const double prefactor = std::exp(-x + a * std::log(x) - std::lgamma(a));
+    if (x < a + 1.)
+    {
+      // series of P(a, x)
+      double ap = a, term = 1. / a, sum = term;
+      for (int n = 0; n < 1000 && std::abs(term) > std::abs(sum) * 1e-15; ++n)
+      {
+        ap += 1.;
+        term *= x / ap;
+        sum += term;
+      }
+      return std::max(0., 1. - sum * prefactor);
+    }
+    // continued fraction of Q(a, x), modified Lentz
+    const double tiny = 1e-300;
+    double b = x + 1. - a, c = 1. / tiny, d = 1. / b, h = d;
+    for (int i = 1; i < 1000; ++i)
+    {
+      const double an = -i * (i - a);
+      b += 2.;
+      d = an * d + b;
+      d = std::abs(d) < tiny ? tiny : d;
+      c = b + an / c;
+      c = std::abs(c) < tiny ? tiny : c;
+      d = 1. / d;
+      h *= d * c;
+      if (std::abs(d * c - 1.) < 1e-15)
+        break;
+    }
+    return prefactor * h;
+  }
+
+  inline double Chi2Probability(double chi2, int ndf)
+  {
+    return ndf > 0 ? GammaQ(0.5 * ndf, 0.5 * chi2) : 1.;
+  }
+
+  /// Histograms of the two sorted samples over their common range in nbins
+  /// bins; a sample without spread (or with non-finite values at the edges)
+  /// falls into the first bin
+  inline void FillHistograms(const std::vector<double> &a, const std::vector<double> &b, int nbins,
+                             std::vector<double> &ha, std::vector<double> &hb)
+  {
+    nbins = std::max(nbins, 1);
+    ha.assign(nbins, 0.);
+    hb.assign(nbins, 0.);
+    if (a.empty() && b.empty())
+      return;
+    const double lo = std::min(a.empty() ? b.front() : a.front(), b.empty() ? a.front() : b.front());
+    const double hi = std::max(a.empty() ? b.back() : a.back(), b.empty() ? a.back() : b.back());
+    const double width = (hi - lo) / nbins;
+    const bool spread = width > 0. && std::isfinite(width);
+    const auto bin = [&](double v)
+    { return spread && std::isfinite(v) ? std::clamp(int((v - lo) / width), 0, nbins - 1) : 0; };
+    for (const auto v : a)
+      ha[bin(v)] += 1;
+    for (const auto v : b)
+      hb[bin(v)] += 1;
+  }
+
+  /// Two-sample chi2 of histograms with different normalization; ndf is the
+  /// number of filled bins minus one, -1 if a histogram is empty
+  inline void HistogramChi2(const std::vector<double> &ha, const std::vector<double> &hb, double &chi2, int &ndf)
+  {
+    double na = 0., nb = 0.;
+    for (size_t k = 0; k < ha.size(); ++k)
+    {
+      na += ha[k];
+      nb += hb[k];
+    }
+    chi2 = 0.;
+    ndf = -1;
+    if (na == 0. || nb == 0.)
+      return;
+    for (size_t k = 0; k < ha.size(); ++k)
+    {
+      if (ha[k] + hb[k] == 0)
+        continue;
+      const double diff = ha[k] * std::sqrt(nb / na) - hb[k] * std::sqrt(na / nb);
+      chi2 += diff * diff / (ha[k] + hb[k]);
+      ++ndf;
+    }
+  }
+
+}
+
+#endif
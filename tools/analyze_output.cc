@@ -0,0 +1,670 @@
+/// \file analyze_output.cc
+/// \brief Multi-threaded histogramming of the simulation output
+///
+///   analyze_output <prefix> <histograms.parquet> [options]
+///
+///   --threads <n>            threads for reading and filling (default: hardware concurrency)
+///   --bins <n>               bins of the energy axes (default 200)
+///   --eff-bins <n>           bins of the efficiency curves (default 40)
+///   --strip-threshold <MeV>  strip threshold of the coincidence (default 0.05)
+///   --front-threshold <MeV>  front Si threshold of dE-E (default 0.05)
+///   --csi-threshold <MeV>    CsI threshold of the coincidence and dE-E (default 0.5)
+///
+/// Replaces the Python analysis of the eDep and evtInfo tables below the
+/// prefix (shards and run partitions included). The files are read
+/// concurrently, only the needed columns and each with the column-parallel
+/// Arrow reader. Hits are joined to their event by event ID within the
+/// same run of the same dataset directory; the hits of an event
+/// are in one file, so the threads write disjoint events. Each thread fills
+/// its own histograms, computing the bins of a block of values in one
+/// branch-free pass the compiler vectorizes, and the histograms are summed
+/// at the end. The axes span the range of the data.
+///
+/// The histograms (eDep per detector, strip and crystal spectra, front dE
+/// against summed CsI E, and the primaries of all and of coincidence events
+/// against eProton and theta) are written as one row each to a Parquet file
+/// with the axes and only the non-empty bins; the efficiency tables are
+/// also printed. The thresholds default to those of ExpConstants.hh and are
+/// inclusive, as in Reconstruction; a coincidence is a strip and a CsI
+/// crystal at or above threshold, as for --precision.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+
+#include "DatasetFiles.hh"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  struct Options
+  {
+    int threads = 0;
+    int bins = 200;
+    int effBins = 40;
+    double stripThreshold = 0.05;
+    double frontThreshold = 0.05;
+    double csiThreshold = 0.5;
+  };
+
+  enum Detector : int8_t
+  {
+    kFront,
+    kSi,
+    kCsI,
+    kNDetectors
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  struct Axis
+  {
+    std::string label;
+    int bins = 1;
+    double lo = 0.;
+    double hi = 1.;
+  };
+
+  /// Bin of every value, -1 outside the axis; branch-free over contiguous
+  /// values, so the compiler vectorizes it
+  void BinIndices(const Axis &axis, const double *values, int64_t n, int32_t *bins)
+  {
+    const double scale = axis.bins / (axis.hi - axis.lo);
+    const double lo = axis.lo;
+    const double nBins = axis.bins;
+    for (int64_t i = 0; i < n; ++i)
+    {
+      const double t = (values[i] - lo) * scale;
+      bins[i] = t >= 0. && t < nBins ? static_cast<int32_t>(t) : -1;
+    }
+  }
+
+  class Histogram
+  {
+  public:
+    Histogram(const std::string &name, const Axis &x, const Axis &y = Axis())
+        : name_(name), x_(x), y_(y), counts_(static_cast<size_t>(x.bins) * y.bins)
+    {
+    }
+
+    /// Fills a block of values, 1D
+    void Fill(const double *x, int64_t n)
+    {
+      bins_.resize(n);
+      BinIndices(x_, x, n, bins_.data());
+      Count(n);
+    }
+
+    /// Fills a block of value pairs, 2D
+    void Fill(const double *x, const double *y, int64_t n)
+    {
+      bins_.resize(n);
+      yBins_.resize(n);
+      BinIndices(x_, x, n, bins_.data());
+      BinIndices(y_, y, n, yBins_.data());
+      const int32_t nx = x_.bins;
+      for (int64_t i = 0; i < n; ++i)
+        bins_[i] = bins_[i] >= 0 && yBins_[i] >= 0 ? yBins_[i] * nx + bins_[i] : -1;
+      Count(n);
+    }
+
+    void Add(const Histogram &other)
+    {
+      for (size_t i = 0; i < counts_.size(); ++i)
+        counts_[i] += other.counts_[i];
+    }
+
+    const std::string &Name() const { return name_; }
+    const Axis &X() const { return x_; }
+    const Axis &Y() const { return y_; }
+    const std::vector<double> &Counts() const { return counts_; }
+
+  private:
+    void Count(int64_t n)
+    {
+      for (int64_t i = 0; i < n; ++i)
+      {
+        if (bins_[i] >= 0)
+          counts_[bins_[i]] += 1.;
+      }
+    }
+
+    std::string name_;
+    Axis x_, y_;
+    std::vector<double> counts_;
+    // bins of the block being filled
+    std::vector<int32_t> bins_, yBins_;
+  };
+
+  enum HistogramId
+  {
+    kEDepFront,
+    kEDepSi,
+    kEDepCsI,
+    kStripEDep,
+    kCrystalEDep,
+    kDeltaEE,
+    kEProtonAll,
+    kEProtonCoincidence,
+    kThetaAll,
+    kThetaCoincidence
+  };
+
+  /// Ranges of the data, from the tables
+  struct Ranges
+  {
+    double eDepMax[kNDetectors] = {0., 0., 0.};
+    int32_t copyMax[kNDetectors] = {0, 0, 0};
+    double eProtonMin = std::numeric_limits<double>::max();
+    double eProtonMax = std::numeric_limits<double>::lowest();
+    double thetaMax = 0.;
+    double csiSumMax = 0.;
+
+    void Merge(const Ranges &other)
+    {
+      for (int d = 0; d < kNDetectors; ++d)
+      {
+        eDepMax[d] = std::max(eDepMax[d], other.eDepMax[d]);
+        copyMax[d] = std::max(copyMax[d], other.copyMax[d]);
+      }
+      eProtonMin = std::min(eProtonMin, other.eProtonMin);
+      eProtonMax = std::max(eProtonMax, other.eProtonMax);
+      thetaMax = std::max(thetaMax, other.thetaMax);
+    }
+  };
+
+  /// Axis over [lo, hi], widened by half a bin so hi falls inside
+  Axis DataAxis(const std::string &label, int bins, double lo, double hi)
+  {
+    if (!(hi > lo))
+      hi = lo + 1.;
+    return {label, bins, lo, hi + 0.5 * (hi - lo) / bins};
+  }
+
+  /// Axis of integer IDs 0..max, one bin each
+  Axis IdAxis(const std::string &label, int32_t max)
+  {
+    return {label, max + 1, -0.5, max + 0.5};
+  }
+
+  std::vector<Histogram> MakeHistograms(const Ranges &ranges, const Options &options)
+  {
+    const auto eAxis = [&ranges, &options](Detector det, const std::string &label)
+    { return DataAxis(label, options.bins, 0., ranges.eDepMax[det]); };
+    const Axis eProton = DataAxis("eProton [MeV]", options.effBins, ranges.eProtonMin, ranges.eProtonMax);
+    const Axis theta = DataAxis("theta [deg]", options.effBins, 0., ranges.thetaMax);
+    return {
+        Histogram("eDep_front", eAxis(kFront, "front eDep [MeV]")),
+        Histogram("eDep_Si", eAxis(kSi, "strip eDep [MeV]")),
+        Histogram("eDep_CsI", eAxis(kCsI, "crystal eDep [MeV]")),
+        Histogram("strip_eDep", IdAxis("strip", ranges.copyMax[kSi]), eAxis(kSi, "strip eDep [MeV]")),
+        Histogram("crystal_eDep", IdAxis("crystal", ranges.copyMax[kCsI]), eAxis(kCsI, "crystal eDep [MeV]")),
+        Histogram("dE_E", DataAxis("CsI E [MeV]", options.bins, 0., ranges.csiSumMax), eAxis(kFront, "front dE [MeV]")),
+        Histogram("eProton_all", eProton),
+        Histogram("eProton_coincidence", eProton),
+        Histogram("theta_all", theta),
+        Histogram("theta_coincidence", theta),
+    };
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  struct File
+  {
+    fs::path path;
+    int group = 0;
+    // run of the partition, -1 outside one
+    int64_t runId = -1;
+    std::shared_ptr<arrow::Table> table;
+    // first event of the file in the event arrays, evtInfo only
+    int64_t firstEvent = 0;
+  };
+
+  std::vector<File> GroupFiles(const std::string &prefix, const std::string &table, std::map<std::string, int> &groups)
+  {
+    std::vector<File> files;
+    for (const auto &path : tables::FindFiles(prefix, table))
+    {
+      // events are joined within their dataset directory and run partition
+      const std::string group = tables::TableDir(path).parent_path().string() + "|" + tables::RunPartition(path);
+      const auto itr = groups.emplace(group, static_cast<int>(groups.size())).first;
+      files.push_back({path, itr->second, tables::RunId(path), nullptr, 0});
+    }
+    return files;
+  }
+
+  template <typename ArrayType>
+  std::shared_ptr<ArrayType> Column(const std::shared_ptr<arrow::Table> &table, const std::string &name)
+  {
+    return std::static_pointer_cast<ArrayType>(table->GetColumnByName(name)->chunk(0));
+  }
+
+  /// Calls task(index, thread) for every index from a pool of threads; the
+  /// first exception of a task is rethrown after all threads finished
+  void ParallelFor(size_t n, int threads, const std::function<void(size_t, int)> &task)
+  {
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+    {
+      pool.emplace_back(
+          [&, t]()
+          {
+            try
+            {
+              for (size_t i = next++; i < n; i = next++)
+                task(i, t);
+            }
+            catch (...)
+            {
+              std::lock_guard<std::mutex> lock(errorMutex);
+              if (!error)
+                error = std::current_exception();
+              next = n;
+            }
+          });
+    }
+    for (auto &thread : pool)
+      thread.join();
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  using EventIndex = std::unordered_map<tables::EventKey, int64_t, tables::EventKeyHash>;
+
+  /// Per-event sums of the hits, indexed like the evtInfo rows
+  struct EventSums
+  {
+    std::vector<double> front;
+    std::vector<double> csi;
+    // a strip, a crystal at or above threshold
+    std::vector<uint8_t> strip;
+    std::vector<uint8_t> crystal;
+  };
+
+  /// Joins the hits of an eDep file to their events and fills the hit
+  /// histograms; returns the hits without an event
+  int64_t FillHits(const File &file, const EventIndex &index, const Options &options,
+                   std::vector<Histogram> &histograms, EventSums &sums)
+  {
+    const auto &table = file.table;
+    const auto eventId = Column<arrow::Int64Array>(table, "eventId");
+    const auto detName = Column<arrow::StringArray>(table, "detName");
+    const auto copyId = Column<arrow::Int32Array>(table, "copyId");
+    const auto eDep = Column<arrow::DoubleArray>(table, "eDep");
+    const int64_t n = table->num_rows();
+
+    // gather the hits per detector into contiguous blocks
+    std::vector<double> values[kNDetectors], copies[kNDetectors];
+    int64_t unmatched = 0;
+    for (int64_t i = 0; i < n; ++i)
+    {
+      const auto name = detName->GetView(i);
+      const int det = name == "Si" ? kSi : name == "CsI" ? kCsI : name == "front" ? kFront : -1;
+      if (det < 0)
+        continue;
+      const double e = eDep->Value(i);
+      values[det].push_back(e);
+      copies[det].push_back(copyId->Value(i));
+
+      const auto event = index.find({file.runId, eventId->Value(i)});
+      if (event == index.end())
+      {
+        ++unmatched;
+        continue;
+      }
+      const int64_t k = event->second;
+      if (det == kFront)
+        sums.front[k] += e;
+      else if (det == kCsI)
+      {
+        sums.csi[k] += e;
+        sums.crystal[k] |= e >= options.csiThreshold;
+      }
+      else
+        sums.strip[k] |= e >= options.stripThreshold;
+    }
+
+    histograms[kEDepFront].Fill(values[kFront].data(), values[kFront].size());
+    histograms[kEDepSi].Fill(values[kSi].data(), values[kSi].size());
+    histograms[kEDepCsI].Fill(values[kCsI].data(), values[kCsI].size());
+    histograms[kStripEDep].Fill(copies[kSi].data(), values[kSi].data(), values[kSi].size());
+    histograms[kCrystalEDep].Fill(copies[kCsI].data(), values[kCsI].data(), values[kCsI].size());
+    return unmatched;
+  }
+
+  /// Fills the event histograms of the events of an evtInfo file
+  void FillEvents(const File &file, const Options &options, const EventSums &sums, std::vector<Histogram> &histograms)
+  {
+    const auto eProton = Column<arrow::DoubleArray>(file.table, "eProton");
+    const auto theta = Column<arrow::DoubleArray>(file.table, "theta");
+    const int64_t n = file.table->num_rows();
+    const int64_t first = file.firstEvent;
+
+    std::vector<double> thetaDeg(n), dE, e, coincidenceEProton, coincidenceTheta;
+    for (int64_t i = 0; i < n; ++i)
+      thetaDeg[i] = theta->Value(i) * (180. / M_PI);
+    for (int64_t i = 0; i < n; ++i)
+    {
+      const int64_t k = first + i;
+      if (sums.front[k] >= options.frontThreshold && sums.csi[k] >= options.csiThreshold)
+      {
+        dE.push_back(sums.front[k]);
+        e.push_back(sums.csi[k]);
+      }
+      if (sums.strip[k] && sums.crystal[k])
+      {
+        coincidenceEProton.push_back(eProton->Value(i));
+        coincidenceTheta.push_back(thetaDeg[i]);
+      }
+    }
+
+    histograms[kDeltaEE].Fill(e.data(), dE.data(), e.size());
+    histograms[kEProtonAll].Fill(eProton->raw_values(), n);
+    histograms[kEProtonCoincidence].Fill(coincidenceEProton.data(), coincidenceEProton.size());
+    histograms[kThetaAll].Fill(thetaDeg.data(), n);
+    histograms[kThetaCoincidence].Fill(coincidenceTheta.data(), coincidenceTheta.size());
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  /// One row per histogram with its axes and the indices and counts of the
+  /// non-empty bins (row-major, x fastest)
+  void WriteHistograms(const std::string &fname, const std::vector<Histogram> &histograms,
+                       const std::string &prefix)
+  {
+    arrow::StringBuilder name, xLabel, yLabel;
+    arrow::Int32Builder xBins, yBins;
+    arrow::DoubleBuilder xMin, xMax, yMin, yMax, entries;
+    arrow::ListBuilder bins(arrow::default_memory_pool(), std::make_shared<arrow::Int32Builder>());
+    arrow::ListBuilder counts(arrow::default_memory_pool(), std::make_shared<arrow::DoubleBuilder>());
+    auto binValues = static_cast<arrow::Int32Builder *>(bins.value_builder());
+    auto countValues = static_cast<arrow::DoubleBuilder *>(counts.value_builder());
+    for (const auto &histogram : histograms)
+    {
+      PARQUET_THROW_NOT_OK(name.Append(histogram.Name()));
+      PARQUET_THROW_NOT_OK(xLabel.Append(histogram.X().label));
+      PARQUET_THROW_NOT_OK(xBins.Append(histogram.X().bins));
+      PARQUET_THROW_NOT_OK(xMin.Append(histogram.X().lo));
+      PARQUET_THROW_NOT_OK(xMax.Append(histogram.X().hi));
+      PARQUET_THROW_NOT_OK(yLabel.Append(histogram.Y().label));
+      PARQUET_THROW_NOT_OK(yBins.Append(histogram.Y().bins));
+      PARQUET_THROW_NOT_OK(yMin.Append(histogram.Y().lo));
+      PARQUET_THROW_NOT_OK(yMax.Append(histogram.Y().hi));
+      PARQUET_THROW_NOT_OK(bins.Append());
+      PARQUET_THROW_NOT_OK(counts.Append());
+      double sum = 0.;
+      const auto &values = histogram.Counts();
+      for (size_t i = 0; i < values.size(); ++i)
+      {
+        if (values[i] == 0.)
+          continue;
+        PARQUET_THROW_NOT_OK(binValues->Append(static_cast<int32_t>(i)));
+        PARQUET_THROW_NOT_OK(countValues->Append(values[i]));
+        sum += values[i];
+      }
+      PARQUET_THROW_NOT_OK(entries.Append(sum));
+    }
+
+    arrow::FieldVector fields;
+    arrow::ArrayVector arrays;
+    const auto add = [&fields, &arrays](const std::string &field, arrow::ArrayBuilder &builder)
+    {
+      std::shared_ptr<arrow::Array> array;
+      PARQUET_THROW_NOT_OK(builder.Finish(&array));
+      fields.push_back(arrow::field(field, array->type()));
+      arrays.push_back(array);
+    };
+    add("name", name);
+    add("xLabel", xLabel);
+    add("xBins", xBins);
+    add("xMin", xMin);
+    add("xMax", xMax);
+    add("yLabel", yLabel);
+    add("yBins", yBins);
+    add("yMin", yMin);
+    add("yMax", yMax);
+    add("entries", entries);
+    add("bin", bins);
+    add("count", counts);
+    const auto metadata = arrow::key_value_metadata({"octupole.source"}, {prefix});
+    const auto table = arrow::Table::Make(arrow::schema(fields, metadata), arrays);
+
+    std::shared_ptr<arrow::io::FileOutputStream> outfile;
+    PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(fname));
+    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), outfile));
+  }
+
+  void PrintEfficiency(const Histogram &all, const Histogram &coincidence)
+  {
+    const Axis &axis = all.X();
+    const double width = (axis.hi - axis.lo) / axis.bins;
+    std::printf("\n%-24s %10s %10s %10s %10s\n", axis.label.c_str(), "events", "coinc", "eff", "error");
+    for (int i = 0; i < axis.bins; ++i)
+    {
+      const double n = all.Counts()[i];
+      const double k = coincidence.Counts()[i];
+      if (n == 0.)
+        continue;
+      const double eff = k / n;
+      std::printf("%10.4g - %-11.4g %10.0f %10.0f %10.4f %10.4f\n", axis.lo + i * width, axis.lo + (i + 1) * width,
+                  n, k, eff, std::sqrt(eff * (1. - eff) / n));
+    }
+  }
+
+  void PrintUsage(const char *program)
+  {
+    std::cerr << "Usage: " << program << " <prefix> <histograms.parquet> [--threads n] [--bins n] [--eff-bins n]"
+              << " [--strip-threshold MeV] [--front-threshold MeV] [--csi-threshold MeV]" << std::endl;
+  }
+
+  double Seconds(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  Options options;
+  for (int i = 3; i < argc; ++i)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--threads") && hasValue)
+      options.threads = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--bins") && hasValue)
+      options.bins = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--eff-bins") && hasValue)
+      options.effBins = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--strip-threshold") && hasValue)
+      options.stripThreshold = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--front-threshold") && hasValue)
+      options.frontThreshold = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--csi-threshold") && hasValue)
+      options.csiThreshold = std::atof(argv[++i]);
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  if (options.threads <= 0)
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  const std::string prefix = argv[1];
+
+  try
+  {
+    PARQUET_THROW_NOT_OK(arrow::SetCpuThreadPoolCapacity(options.threads));
+    const auto start = std::chrono::steady_clock::now();
+    std::map<std::string, int> groups;
+    auto evtInfoFiles = GroupFiles(prefix, "evtInfo", groups);
+    auto eDepFiles = GroupFiles(prefix, "eDep", groups);
+    if (evtInfoFiles.empty())
+    {
+      std::cerr << "No evtInfo files below " << prefix << std::endl;
+      return 1;
+    }
+
+    // read the tables and the ranges of the data
+    std::vector<Ranges> threadRanges(options.threads);
+    ParallelFor(evtInfoFiles.size(), options.threads,
+                [&](size_t f, int t)
+                {
+                  auto &file = evtInfoFiles[f];
+                  file.table = tables::ReadColumns(file.path, {"eventId", "eProton", "theta"});
+                  const auto eProton = Column<arrow::DoubleArray>(file.table, "eProton");
+                  const auto theta = Column<arrow::DoubleArray>(file.table, "theta");
+                  auto &ranges = threadRanges[t];
+                  for (int64_t i = 0; i < file.table->num_rows(); ++i)
+                  {
+                    ranges.eProtonMin = std::min(ranges.eProtonMin, eProton->Value(i));
+                    ranges.eProtonMax = std::max(ranges.eProtonMax, eProton->Value(i));
+                    ranges.thetaMax = std::max(ranges.thetaMax, theta->Value(i) * (180. / M_PI));
+                  }
+                });
+    ParallelFor(eDepFiles.size(), options.threads,
+                [&](size_t f, int t)
+                {
+                  auto &file = eDepFiles[f];
+                  file.table = tables::ReadColumns(file.path, {"eventId", "detName", "copyId", "eDep"});
+                  const auto detName = Column<arrow::StringArray>(file.table, "detName");
+                  const auto copyId = Column<arrow::Int32Array>(file.table, "copyId");
+                  const auto eDep = Column<arrow::DoubleArray>(file.table, "eDep");
+                  auto &ranges = threadRanges[t];
+                  for (int64_t i = 0; i < file.table->num_rows(); ++i)
+                  {
+                    const auto name = detName->GetView(i);
+                    const int det = name == "Si" ? kSi : name == "CsI" ? kCsI : name == "front" ? kFront : -1;
+                    if (det < 0)
+                      continue;
+                    ranges.eDepMax[det] = std::max(ranges.eDepMax[det], eDep->Value(i));
+                    ranges.copyMax[det] = std::max(ranges.copyMax[det], copyId->Value(i));
+                  }
+                });
+    Ranges ranges;
+    for (const auto &threadRange : threadRanges)
+      ranges.Merge(threadRange);
+    const double readSeconds = Seconds(start);
+
+    // index the events of every group by run and event ID
+    int64_t nEvents = 0;
+    std::vector<std::vector<const File *>> groupFiles(groups.size());
+    for (auto &file : evtInfoFiles)
+    {
+      file.firstEvent = nEvents;
+      nEvents += file.table->num_rows();
+      groupFiles[file.group].push_back(&file);
+    }
+    if (nEvents == 0)
+    {
+      std::cerr << "No events below " << prefix << std::endl;
+      return 1;
+    }
+    std::vector<EventIndex> indices(groups.size());
+    ParallelFor(groups.size(), options.threads,
+                [&](size_t g, int)
+                {
+                  for (const File *file : groupFiles[g])
+                  {
+                    const auto eventId = Column<arrow::Int64Array>(file->table, "eventId");
+                    for (int64_t i = 0; i < file->table->num_rows(); ++i)
+                      indices[g][{file->runId, eventId->Value(i)}] = file->firstEvent + i;
+                  }
+                });
+
+    // hits, joined to their events
+    EventSums sums;
+    sums.front.assign(nEvents, 0.);
+    sums.csi.assign(nEvents, 0.);
+    sums.strip.assign(nEvents, 0);
+    sums.crystal.assign(nEvents, 0);
+    std::vector<std::vector<Histogram>> threadHistograms(options.threads);
+    std::vector<int64_t> unmatched(options.threads, 0);
+    ParallelFor(eDepFiles.size(), options.threads,
+                [&](size_t f, int t)
+                {
+                  if (threadHistograms[t].empty())
+                    threadHistograms[t] = MakeHistograms(ranges, options);
+                  unmatched[t] +=
+                      FillHits(eDepFiles[f], indices[eDepFiles[f].group], options, threadHistograms[t], sums);
+                });
+    for (const double csi : sums.csi)
+      ranges.csiSumMax = std::max(ranges.csiSumMax, csi);
+
+    // event histograms, with the dE-E axis from the summed CsI energies
+    std::vector<std::vector<Histogram>> eventHistograms(options.threads);
+    ParallelFor(evtInfoFiles.size(), options.threads,
+                [&](size_t f, int t)
+                {
+                  if (eventHistograms[t].empty())
+                    eventHistograms[t] = MakeHistograms(ranges, options);
+                  FillEvents(evtInfoFiles[f], options, sums, eventHistograms[t]);
+                });
+
+    auto histograms = MakeHistograms(ranges, options);
+    for (int t = 0; t < options.threads; ++t)
+    {
+      for (size_t h = 0; h < histograms.size(); ++h)
+      {
+        // hit and event histograms of a thread are disjoint
+        if (!threadHistograms[t].empty() && h < kDeltaEE)
+          histograms[h].Add(threadHistograms[t][h]);
+        if (!eventHistograms[t].empty() && h >= kDeltaEE)
+          histograms[h].Add(eventHistograms[t][h]);
+      }
+    }
+    WriteHistograms(argv[2], histograms, prefix);
+
+    int64_t nHits = 0, nUnmatched = 0;
+    for (const auto &file : eDepFiles)
+      nHits += file.table->num_rows();
+    for (const auto count : unmatched)
+      nUnmatched += count;
+    const double seconds = Seconds(start);
+    std::printf("%ld events, %ld hits in %zu + %zu files, %zu groups, %d threads\n", nEvents, nHits,
+                evtInfoFiles.size(), eDepFiles.size(), groups.size(), options.threads);
+    std::printf("read %.2f s, total %.2f s, %.3g events/s\n", readSeconds, seconds, nEvents / seconds);
+    if (nUnmatched > 0)
+      std::printf("warning: %ld hits without an event in evtInfo\n", nUnmatched);
+    PrintEfficiency(histograms[kEProtonAll], histograms[kEProtonCoincidence]);
+    PrintEfficiency(histograms[kThetaAll], histograms[kThetaCoincidence]);
+    std::printf("\nwrote %zu histograms to %s\n", histograms.size(), argv[2]);
+  }
+  catch (const std::exception &error)
+  {
+    std::cerr << "analyze_output: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,114 @@
+/// \file compare_edep.cc
+/// \brief Compares the energy deposit spectra of two output datasets
+///
+///   compare_edep <referencePrefix> <testPrefix> [nbins]
+///
+/// Reads the eDep/*.parquet files below <prefix> of both datasets (the prefix
+/// of a sharded dataset includes all its shards, and the table of every run
+/// partition eDep/run=<ID> is read) and prints, per detector,
+/// the number of hits, the mean and rms deposit, the two-sample chi2 of the
+/// histogrammed spectra and the Kolmogorov-Smirnov distance.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/exception.h>
+
+#include "DatasetFiles.hh"
+#include "Statistics.hh"
+
+namespace
+{
+  using Spectra = std::map<std::string, std::vector<double>>;
+
+  Spectra ReadSpectra(const std::string &prefix)
+  {
+    Spectra spectra;
+    // a sharded dataset has the eDep directories of its shards below the prefix
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(prefix))
+    {
+      if (!tables::InTable(entry.path(), "eDep"))
+        continue;
+      std::shared_ptr<arrow::io::ReadableFile> infile;
+      PARQUET_ASSIGN_OR_THROW(infile, arrow::io::ReadableFile::Open(entry.path().string()));
+      std::unique_ptr<parquet::arrow::FileReader> reader;
+      PARQUET_THROW_NOT_OK(parquet::arrow::OpenFile(infile, arrow::default_memory_pool(), &reader));
+      std::shared_ptr<arrow::Table> table;
+      PARQUET_THROW_NOT_OK(reader->ReadTable(&table));
+      if (table->num_rows() == 0)
+        continue;
+      PARQUET_ASSIGN_OR_THROW(table, table->CombineChunks());
+
+      auto detName = std::static_pointer_cast<arrow::StringArray>(table->GetColumnByName("detName")->chunk(0));
+      auto eDep = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("eDep")->chunk(0));
+      for (int64_t i = 0; i < table->num_rows(); ++i)
+      {
+        spectra[detName->GetString(i)].emplace_back(eDep->Value(i));
+      }
+    }
+    for (auto &spectrum : spectra)
+    {
+      std::sort(spectrum.second.begin(), spectrum.second.end());
+    }
+    return spectra;
+  }
+
+  /// Two-sample chi2 of the histogrammed spectra, returns chi2/ndf
+  double Chi2PerNdf(const std::vector<double> &a, const std::vector<double> &b, int nbins)
+  {
+    if (a.empty() || b.empty())
+      return 0;
+    std::vector<double> ha, hb;
+    stats::FillHistograms(a, b, nbins, ha, hb);
+    double chi2;
+    int ndf;
+    stats::HistogramChi2(ha, hb, chi2, ndf);
+    return ndf > 0 ? chi2 / ndf : 0;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " <referencePrefix> <testPrefix> [nbins]" << std::endl;
+    return 1;
+  }
+  const int nbins = argc > 3 ? std::max(1, std::atoi(argv[3])) : 100;
+  const Spectra reference = ReadSpectra(argv[1]);
+  const Spectra test = ReadSpectra(argv[2]);
+
+  std::cout << std::left << std::setw(8) << "det"
+            << std::right << std::setw(12) << "hits ref" << std::setw(12) << "hits test"
+            << std::setw(14) << "mean ref" << std::setw(14) << "mean test"
+            << std::setw(14) << "rms ref" << std::setw(14) << "rms test"
+            << std::setw(12) << "chi2/ndf" << std::setw(10) << "KS" << std::endl;
+  std::map<std::string, bool> detectors;
+  for (const auto &spectrum : reference)
+    detectors[spectrum.first] = true;
+  for (const auto &spectrum : test)
+    detectors[spectrum.first] = true;
+  const std::vector<double> empty;
+  for (const auto &det : detectors)
+  {
+    const auto &ref = reference.count(det.first) ? reference.at(det.first) : empty;
+    const auto &tst = test.count(det.first) ? test.at(det.first) : empty;
+    std::cout << std::left << std::setw(8) << det.first
+              << std::right << std::setw(12) << ref.size() << std::setw(12) << tst.size()
+              << std::setw(14) << stats::Mean(ref) << std::setw(14) << stats::Mean(tst)
+              << std::setw(14) << stats::Rms(ref) << std::setw(14) << stats::Rms(tst)
+              << std::setw(12) << Chi2PerNdf(ref, tst, nbins)
+              << std::setw(10) << stats::KolmogorovDistance(ref, tst) << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,386 @@
+/// \file overlay_events.cc
+/// \brief Builds pile-up events by overlaying stored single-reaction events
+///
+///   overlay_events <sourcePrefix> <outputPrefix> [options]
+///
+///   --rate <Hz>             reaction rate (default 1e5)
+///   --window <ns>           integration window around the trigger (default 1000)
+///   --pileup poisson|fixed:<k>
+///                           extra reactions per event: Poisson with mean
+///                           rate * window (default), or exactly k
+///   --response box|exp:<ns> weight of an extra reaction at time t: 1 inside
+///                           the window (default), or exp(-|t|/tau)
+///   --events <n>            events to build (default: one per source event)
+///   --block <n>             events per output file (default 100000)
+///   --threads <n>           worker threads (default: hardware concurrency)
+///   --seed <s>              random seed (default 12345)
+///
+/// Every synthetic event starts from a trigger reaction, the source events
+/// in turn, and adds the hits of extra reactions drawn at random from the
+/// source, each at a time uniform in [-window/2, window/2]. Deposits of the
+/// reactions in the same detector and copy are summed, as the detector
+/// would. The output has the schema of exampleB1 (eDep/overlay_<b>.parquet
+/// with the summed hits, evtInfo/overlay_<b>.parquet with the primary of
+/// the trigger), so the analysis and validate_output read it unchanged,
+/// plus overlay/overlay_<b>.parquet with the source event (run partition,
+/// -1 outside one, and event ID) and time of every reaction of an event.
+///
+/// The source (a sharded dataset includes all its shards) is read in file
+/// name order and held in memory as per-event hit ranges. The events are
+/// cut into blocks of --block events; the threads take the blocks in turn
+/// and write the files of block b, with b in the workerId column. Every
+/// event has its own random stream, so the files and their contents do not
+/// depend on the thread count.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+
+#include "DatasetFiles.hh"
+
+namespace
+{
+  struct Options
+  {
+    double rate = 1e5;
+    double window = 1000.;
+    int fixedPileup = -1;
+    double tau = 0.;
+    int64_t events = 0;
+    int64_t blockEvents = 100000;
+    int threads = 0;
+    uint64_t seed = 12345;
+  };
+
+  /// Hits of all source events, grouped by event
+  struct Source
+  {
+    std::vector<std::string> detNames;
+    /// run of the partition (-1 outside one) and event ID of each event
+    std::vector<int64_t> runIds, eventIds;
+    std::vector<double> eProton, theta, phi;
+    /// hits of event i are [offsets[i], offsets[i + 1])
+    std::vector<int64_t> offsets;
+    std::vector<int32_t> detIndex, copyId;
+    std::vector<double> eDep;
+  };
+
+  Source ReadSource(const std::string &prefix)
+  {
+    Source source;
+    // event IDs restart in every run partition
+    std::unordered_map<tables::EventKey, int64_t, tables::EventKeyHash> eventIndex;
+    for (const auto &[runId, table] : tables::ReadTables(prefix, "evtInfo"))
+    {
+      auto eventId = std::static_pointer_cast<arrow::Int64Array>(table->GetColumnByName("eventId")->chunk(0));
+      auto eProton = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("eProton")->chunk(0));
+      auto theta = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("theta")->chunk(0));
+      auto phi = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("phi")->chunk(0));
+      for (int64_t i = 0; i < table->num_rows(); ++i)
+      {
+        eventIndex[{runId, eventId->Value(i)}] = source.eventIds.size();
+        source.runIds.emplace_back(runId);
+        source.eventIds.emplace_back(eventId->Value(i));
+        source.eProton.emplace_back(eProton->Value(i));
+        source.theta.emplace_back(theta->Value(i));
+        source.phi.emplace_back(phi->Value(i));
+      }
+    }
+
+    // hits in file order, then grouped by event with a counting sort
+    std::vector<int64_t> hitEvent;
+    std::vector<int32_t> detIndex, copyId;
+    std::vector<double> eDep;
+    std::map<std::string, int32_t> detectors;
+    for (const auto &[runId, table] : tables::ReadTables(prefix, "eDep"))
+    {
+      auto eventId = std::static_pointer_cast<arrow::Int64Array>(table->GetColumnByName("eventId")->chunk(0));
+      auto detName = std::static_pointer_cast<arrow::StringArray>(table->GetColumnByName("detName")->chunk(0));
+      auto copy = std::static_pointer_cast<arrow::Int32Array>(table->GetColumnByName("copyId")->chunk(0));
+      auto dep = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("eDep")->chunk(0));
+      for (int64_t i = 0; i < table->num_rows(); ++i)
+      {
+        const auto itr = eventIndex.find({runId, eventId->Value(i)});
+        if (itr == eventIndex.end())
+          continue;
+        const auto det = detectors.emplace(detName->GetString(i), static_cast<int32_t>(detectors.size())).first;
+        hitEvent.emplace_back(itr->second);
+        detIndex.emplace_back(det->second);
+        copyId.emplace_back(copy->Value(i));
+        eDep.emplace_back(dep->Value(i));
+      }
+    }
+    source.detNames.resize(detectors.size());
+    for (const auto &det : detectors)
+      source.detNames[det.second] = det.first;
+
+    const int64_t nEvents = source.eventIds.size();
+    source.offsets.assign(nEvents + 1, 0);
+    for (const auto event : hitEvent)
+      ++source.offsets[event + 1];
+    for (int64_t i = 0; i < nEvents; ++i)
+      source.offsets[i + 1] += source.offsets[i];
+    std::vector<int64_t> next(source.offsets.begin(), source.offsets.end() - 1);
+    source.detIndex.resize(hitEvent.size());
+    source.copyId.resize(hitEvent.size());
+    source.eDep.resize(hitEvent.size());
+    for (size_t h = 0; h < hitEvent.size(); ++h)
+    {
+      const int64_t slot = next[hitEvent[h]]++;
+      source.detIndex[slot] = detIndex[h];
+      source.copyId[slot] = copyId[h];
+      source.eDep[slot] = eDep[h];
+    }
+    return source;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  std::shared_ptr<arrow::Schema> EDepSchema()
+  {
+    return arrow::schema({arrow::field("workerId", arrow::int32()), arrow::field("eventId", arrow::int64()),
+                          arrow::field("detName", arrow::utf8()), arrow::field("copyId", arrow::int32()),
+                          arrow::field("eDep", arrow::float64())});
+  }
+
+  std::shared_ptr<arrow::Schema> EvtInfoSchema()
+  {
+    return arrow::schema({arrow::field("workerId", arrow::int32()), arrow::field("eventId", arrow::int64()),
+                          arrow::field("eProton", arrow::float64()), arrow::field("theta", arrow::float64()),
+                          arrow::field("phi", arrow::float64())});
+  }
+
+  std::shared_ptr<arrow::Schema> OverlaySchema()
+  {
+    return arrow::schema({arrow::field("eventId", arrow::int64()), arrow::field("reaction", arrow::int32()),
+                          arrow::field("sourceRunId", arrow::int64()), arrow::field("sourceEventId", arrow::int64()),
+                          arrow::field("time", arrow::float64()), arrow::field("weight", arrow::float64())});
+  }
+
+  template <typename Builder>
+  std::shared_ptr<arrow::Array> Finish(Builder &builder)
+  {
+    std::shared_ptr<arrow::Array> array;
+    PARQUET_THROW_NOT_OK(builder.Finish(&array));
+    return array;
+  }
+
+  void Write(const std::shared_ptr<arrow::Schema> &schema, const arrow::ArrayVector &arrays, const std::string &fname)
+  {
+    const auto table = arrow::Table::Make(schema, arrays);
+    std::shared_ptr<arrow::io::FileOutputStream> outfile;
+    PARQUET_ASSIGN_OR_THROW(outfile, arrow::io::FileOutputStream::Open(fname));
+    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), outfile));
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  /// Builds the events [first, last) of a block and writes its files
+  void Overlay(const Source &source, const Options &options, int64_t block, int64_t first, int64_t last,
+               const std::string &outputPrefix)
+  {
+    const int64_t nSource = source.eventIds.size();
+    arrow::Int32Builder workerId, copyId, evtWorkerId, reaction;
+    arrow::Int64Builder eventId, evtEventId, ovlEventId, sourceRunId, sourceEventId;
+    arrow::StringBuilder detName;
+    arrow::DoubleBuilder eDep, eProton, theta, phi, time, weight;
+
+    std::uniform_int_distribution<int64_t> pickEvent(0, nSource - 1);
+    std::uniform_real_distribution<double> pickTime(-0.5 * options.window, 0.5 * options.window);
+    std::poisson_distribution<int> pileup(options.rate * options.window * 1e-9);
+    // summed deposit per (detector, copy) of the current event
+    std::map<std::pair<int32_t, int32_t>, double> hits;
+
+    for (int64_t event = first; event < last; ++event)
+    {
+      // a random stream per event keeps the output independent of the threads
+      std::mt19937_64 engine(options.seed ^ (0x9e3779b97f4a7c15ULL * (event + 1)));
+      const int64_t trigger = event % nSource;
+      const int extra = options.fixedPileup >= 0 ? options.fixedPileup : pileup(engine);
+
+      hits.clear();
+      for (int r = 0; r <= extra; ++r)
+      {
+        const int64_t reactionEvent = r == 0 ? trigger : pickEvent(engine);
+        const double t = r == 0 ? 0. : pickTime(engine);
+        const double w = options.tau > 0. ? std::exp(-std::abs(t) / options.tau) : 1.;
+        for (int64_t h = source.offsets[reactionEvent]; h < source.offsets[reactionEvent + 1]; ++h)
+          hits[{source.detIndex[h], source.copyId[h]}] += w * source.eDep[h];
+        PARQUET_THROW_NOT_OK(ovlEventId.Append(event));
+        PARQUET_THROW_NOT_OK(reaction.Append(r));
+        PARQUET_THROW_NOT_OK(sourceRunId.Append(source.runIds[reactionEvent]));
+        PARQUET_THROW_NOT_OK(sourceEventId.Append(source.eventIds[reactionEvent]));
+        PARQUET_THROW_NOT_OK(time.Append(t));
+        PARQUET_THROW_NOT_OK(weight.Append(w));
+      }
+
+      for (const auto &hit : hits)
+      {
+        PARQUET_THROW_NOT_OK(workerId.Append(static_cast<int32_t>(block)));
+        PARQUET_THROW_NOT_OK(eventId.Append(event));
+        PARQUET_THROW_NOT_OK(detName.Append(source.detNames[hit.first.first]));
+        PARQUET_THROW_NOT_OK(copyId.Append(hit.first.second));
+        PARQUET_THROW_NOT_OK(eDep.Append(hit.second));
+      }
+      PARQUET_THROW_NOT_OK(evtWorkerId.Append(static_cast<int32_t>(block)));
+      PARQUET_THROW_NOT_OK(evtEventId.Append(event));
+      PARQUET_THROW_NOT_OK(eProton.Append(source.eProton[trigger]));
+      PARQUET_THROW_NOT_OK(theta.Append(source.theta[trigger]));
+      PARQUET_THROW_NOT_OK(phi.Append(source.phi[trigger]));
+    }
+
+    const std::string id = std::to_string(block);
+    Write(EDepSchema(), {Finish(workerId), Finish(eventId), Finish(detName), Finish(copyId), Finish(eDep)},
+          outputPrefix + "/eDep/overlay_" + id + ".parquet");
+    Write(EvtInfoSchema(), {Finish(evtWorkerId), Finish(evtEventId), Finish(eProton), Finish(theta), Finish(phi)},
+          outputPrefix + "/evtInfo/overlay_" + id + ".parquet");
+    Write(OverlaySchema(),
+          {Finish(ovlEventId), Finish(reaction), Finish(sourceRunId), Finish(sourceEventId), Finish(time),
+           Finish(weight)},
+          outputPrefix + "/overlay/overlay_" + id + ".parquet");
+  }
+
+  void PrintUsage(const char *program)
+  {
+    std::cerr << "Usage: " << program << " <sourcePrefix> <outputPrefix> [--rate Hz] [--window ns]"
+              << " [--pileup poisson|fixed:k] [--response box|exp:ns] [--events n] [--block n] [--threads n]"
+              << " [--seed s]"
+              << std::endl;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  Options options;
+  for (int i = 3; i < argc; ++i)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--rate") && hasValue)
+      options.rate = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--window") && hasValue)
+      options.window = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--pileup") && hasValue)
+    {
+      const std::string model = argv[++i];
+      if (model != "poisson" && std::sscanf(model.c_str(), "fixed:%d", &options.fixedPileup) != 1)
+      {
+        std::cerr << "Invalid pile-up model " << model << ", expected poisson or fixed:<k>" << std::endl;
+        return 1;
+      }
+    }
+    else if (!std::strcmp(argv[i], "--response") && hasValue)
+    {
+      const std::string model = argv[++i];
+      if (model != "box" && (std::sscanf(model.c_str(), "exp:%lf", &options.tau) != 1 || options.tau <= 0.))
+      {
+        std::cerr << "Invalid time response " << model << ", expected box or exp:<ns>" << std::endl;
+        return 1;
+      }
+    }
+    else if (!std::strcmp(argv[i], "--events") && hasValue)
+      options.events = std::atoll(argv[++i]);
+    else if (!std::strcmp(argv[i], "--block") && hasValue)
+      options.blockEvents = std::atoll(argv[++i]);
+    else if (!std::strcmp(argv[i], "--threads") && hasValue)
+      options.threads = std::atoi(argv[++i]);
+    else if (!std::strcmp(argv[i], "--seed") && hasValue)
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  // a Poisson mean of zero is undefined, fixed:0 switches the pile-up off
+  if (!(options.rate > 0.) || !(options.window > 0.) || options.blockEvents <= 0)
+  {
+    std::cerr << "The rate, the window and the block size must be positive" << std::endl;
+    return 1;
+  }
+  if (options.threads <= 0)
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+  const Source source = ReadSource(argv[1]);
+  if (source.eventIds.empty())
+  {
+    std::cerr << "No events in " << argv[1] << std::endl;
+    return 1;
+  }
+  const int64_t nEvents = options.events > 0 ? options.events : source.eventIds.size();
+  const std::string outputPrefix = argv[2];
+  for (const char *dir : {"/eDep", "/evtInfo", "/overlay"})
+    std::filesystem::create_directories(outputPrefix + dir);
+  std::cout << "Overlaying " << nEvents << " events from " << source.eventIds.size() << " source events, "
+            << (options.fixedPileup >= 0 ? options.fixedPileup : options.rate * options.window * 1e-9)
+            << " extra reactions per event, " << options.threads << " threads" << std::endl;
+
+  // the threads take the blocks in turn; an exception leaving a thread would
+  // terminate the program, so the first one is kept for the main thread
+  const int64_t nBlocks = (nEvents + options.blockEvents - 1) / options.blockEvents;
+  std::atomic<int64_t> nextBlock{0};
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  const auto work = [&]()
+  {
+    for (int64_t block = nextBlock++; block < nBlocks; block = nextBlock++)
+    {
+      try
+      {
+        const int64_t first = block * options.blockEvents;
+        Overlay(source, options, block, first, std::min(nEvents, first + options.blockEvents), outputPrefix);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+          error = std::current_exception();
+        nextBlock = nBlocks;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < std::min<int64_t>(options.threads, nBlocks); ++t)
+    threads.emplace_back(work);
+  for (auto &thread : threads)
+    thread.join();
+  if (error)
+  {
+    try
+    {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Overlay failed: " << e.what() << std::endl;
+    }
+    catch (...)
+    {
+      std::cerr << "Overlay failed" << std::endl;
+    }
+    return 1;
+  }
+  return 0;
+}
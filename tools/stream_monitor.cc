@@ -0,0 +1,138 @@
+/// \file stream_monitor.cc
+/// \brief Minimal online consumer of the Arrow IPC stream output
+///
+///   stream_monitor fifo:<path>|unix:<path> [--follow]
+///
+/// Reads one table stream of a job running with --stream, e.g.
+/// "stream_monitor unix:/tmp/octupole.eDep" for --stream unix:/tmp/octupole,
+/// and prints the row count of every record batch as it arrives, with the
+/// running total. For unix: the monitor listens on the socket the job
+/// connects to; for fifo: it opens the named pipe, creating it if needed.
+/// The columns of each batch reference the message buffers read from the
+/// stream, without a further copy. The job keeps its stream open across
+/// runs, so a stream ends with the job or a broken connection; with
+/// --follow the monitor then waits for the next one, e.g. of the next job
+/// or of the job reconnecting, also after a read error. Without --follow a
+/// read error exits with status 1.
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+
+  /// Opens the next stream of the endpoint, -1 on error
+  int OpenStream(const std::string &endpoint, int &listener)
+  {
+    if (endpoint.rfind("unix:", 0) == 0)
+    {
+      if (listener < 0)
+      {
+        const std::string path = endpoint.substr(5);
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(listener, 1) != 0)
+        {
+          std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+          return -1;
+        }
+      }
+      return accept(listener, nullptr, nullptr);
+    }
+    if (endpoint.rfind("fifo:", 0) == 0)
+    {
+      const std::string path = endpoint.substr(5);
+      if (mkfifo(path.c_str(), 0644) != 0 && errno != EEXIST)
+      {
+        std::cerr << "Cannot create the pipe " << path << ": " << std::strerror(errno) << std::endl;
+        return -1;
+      }
+      return open(path.c_str(), O_RDONLY);
+    }
+    std::cerr << "Invalid endpoint " << endpoint << ", expected fifo:<path> or unix:<path>" << std::endl;
+    return -1;
+  }
+
+  /// Reads and reports the batches of one stream; false on a read error
+  bool ReadStream(int fd)
+  {
+    auto file = arrow::io::ReadableFile::Open(fd);
+    if (!file.ok())
+    {
+      close(fd);
+      return false;
+    }
+    auto reader = arrow::ipc::RecordBatchStreamReader::Open(*file);
+    if (!reader.ok())
+    {
+      std::cerr << reader.status().ToString() << std::endl;
+      return false;
+    }
+    std::cout << "stream: " << (*reader)->schema()->ToString() << std::endl;
+
+    int64_t batches = 0, rows = 0;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (true)
+    {
+      const auto status = (*reader)->ReadNext(&batch);
+      if (!status.ok())
+      {
+        std::cerr << status.ToString() << std::endl;
+        return false;
+      }
+      // end of the stream
+      if (!batch)
+        break;
+      ++batches;
+      rows += batch->num_rows();
+      std::cout << "batch " << batches << ": " << batch->num_rows() << " rows, " << rows << " total" << std::endl;
+    }
+    std::cout << "end of stream: " << batches << " batches, " << rows << " rows" << std::endl;
+    return true;
+  }
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " fifo:<path>|unix:<path> [--follow]" << std::endl;
+    return 1;
+  }
+  const std::string endpoint = argv[1];
+  const bool follow = argc > 2 && !std::strcmp(argv[2], "--follow");
+
+  int listener = -1;
+  do
+  {
+    const int fd = OpenStream(endpoint, listener);
+    if (fd < 0)
+      return 1;
+    // the reader owns and closes the descriptor; a broken stream is the end
+    // of it when following
+    if (!ReadStream(fd))
+    {
+      if (!follow)
+        return 1;
+      std::cout << "stream broken, waiting for the next one" << std::endl;
+    }
+  } while (follow);
+  return 0;
+}
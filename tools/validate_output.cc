@@ -0,0 +1,334 @@
+/// \file validate_output.cc
+/// \brief Statistical pass/fail validation of a dataset against a reference
+///
+///   validate_output <referencePrefix> <testPrefix> [options]
+///
+///   --alpha <p>            smallest accepted p-value (default 0.01)
+///   --bins <n>             bins of the eDep spectra (default 100)
+///   --eff-bins <n>         bins of the efficiency curves (default 20)
+///   --ks-tolerance <d>     accepted KS distance of the eDep spectra (default 0)
+///   --mean-tolerance <r>   accepted relative shift of mean eDep and hits/event (default 0)
+///   --eff-tolerance <e>    accepted absolute efficiency difference per bin (default 0)
+///   --report <file>        also write the report to the file
+///
+/// For speed-oriented modes (cuts, kill zones, fast simulation, lean
+/// physics) that must not change the physics output. Reads the eDep and
+/// evtInfo tables below both prefixes (a sharded dataset includes all its
+/// shards; hits belong to the event of the same run partition and event ID)
+/// and runs, per detector:
+///
+///   eDep KS      two-sample Kolmogorov-Smirnov test of the eDep spectra
+///   eDep chi2    two-sample chi2 test of the histogrammed eDep spectra
+///   hits chi2    chi2 test of the hits/event distributions
+///   eff(eProton) and eff(theta)
+///                chi2 test of the fraction of events with a hit in the
+///                detector, per bin of the primary energy and polar angle
+///
+/// A check fails when its p-value is below --alpha and its effect (KS
+/// distance, relative mean shift or largest efficiency difference) is above
+/// the tolerance, so large samples can accept differences that are
+/// significant but negligible. The exit code is 0 when all checks pass, 2
+/// when one fails and 1 on errors. Only the needed columns are read, so a
+/// validation of a few million events takes seconds.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <arrow/api.h>
+#include <parquet/exception.h>
+
+#include "DatasetFiles.hh"
+#include "Statistics.hh"
+
+namespace
+{
+  struct Options
+  {
+    double alpha = 0.01;
+    int bins = 100;
+    int effBins = 20;
+    double ksTolerance = 0.;
+    double meanTolerance = 0.;
+    double effTolerance = 0.;
+    std::string report;
+  };
+
+  /// Primary and hits per detector of an event
+  struct Event
+  {
+    double eProton = 0.;
+    double theta = 0.;
+    std::map<std::string, int> hits;
+  };
+
+  struct Dataset
+  {
+    std::map<std::string, std::vector<double>> spectra;
+    /// event IDs restart in every run partition
+    std::unordered_map<tables::EventKey, Event, tables::EventKeyHash> events;
+  };
+
+  Dataset ReadDataset(const std::string &prefix)
+  {
+    Dataset dataset;
+    for (const auto &[runId, table] : tables::ReadTables(prefix, "evtInfo", {"eventId", "eProton", "theta"}))
+    {
+      auto eventId = std::static_pointer_cast<arrow::Int64Array>(table->GetColumnByName("eventId")->chunk(0));
+      auto eProton = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("eProton")->chunk(0));
+      auto theta = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("theta")->chunk(0));
+      for (int64_t i = 0; i < table->num_rows(); ++i)
+      {
+        auto &event = dataset.events[{runId, eventId->Value(i)}];
+        event.eProton = eProton->Value(i);
+        event.theta = theta->Value(i);
+      }
+    }
+    for (const auto &[runId, table] : tables::ReadTables(prefix, "eDep", {"eventId", "detName", "eDep"}))
+    {
+      auto eventId = std::static_pointer_cast<arrow::Int64Array>(table->GetColumnByName("eventId")->chunk(0));
+      auto detName = std::static_pointer_cast<arrow::StringArray>(table->GetColumnByName("detName")->chunk(0));
+      auto eDep = std::static_pointer_cast<arrow::DoubleArray>(table->GetColumnByName("eDep")->chunk(0));
+      for (int64_t i = 0; i < table->num_rows(); ++i)
+      {
+        const std::string det = detName->GetString(i);
+        dataset.spectra[det].emplace_back(eDep->Value(i));
+        const auto itr = dataset.events.find({runId, eventId->Value(i)});
+        if (itr != dataset.events.end())
+          ++itr->second.hits[det];
+      }
+    }
+    for (auto &spectrum : dataset.spectra)
+      std::sort(spectrum.second.begin(), spectrum.second.end());
+    return dataset;
+  }
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  class Report
+  {
+  public:
+    explicit Report(const Options &options) : options_(options)
+    {
+      out_ << std::left << std::setw(24) << "check" << std::right << std::setw(12) << "statistic"
+           << std::setw(6) << "ndf" << std::setw(12) << "p-value" << std::setw(12) << "effect"
+           << std::setw(8) << "result" << "\n";
+    }
+
+    void Add(const std::string &check, double statistic, int ndf, double p, double effect, double tolerance)
+    {
+      const bool pass = p >= options_.alpha || effect <= tolerance;
+      ++checks_;
+      failures_ += pass ? 0 : 1;
+      out_ << std::left << std::setw(24) << check << std::right << std::setw(12) << std::setprecision(4)
+           << statistic << std::setw(6) << ndf << std::setw(12) << p << std::setw(12) << effect << std::setw(8)
+           << (pass ? "PASS" : "FAIL") << "\n";
+    }
+
+    bool Passed() const { return failures_ == 0; }
+
+    std::string Summary() const
+    {
+      std::ostringstream summary;
+      if (Passed())
+        summary << "validation PASSED: " << checks_ << " checks";
+      else
+        summary << "validation FAILED: " << failures_ << " of " << checks_ << " checks";
+      summary << " (alpha " << options_.alpha << ")\n";
+      return out_.str() + summary.str();
+    }
+
+  private:
+    const Options &options_;
+    std::ostringstream out_;
+    int checks_ = 0;
+    int failures_ = 0;
+  };
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void CheckSpectrum(Report &report, const Options &options, const std::string &det, const std::vector<double> &ref,
+                     const std::vector<double> &test)
+  {
+    const double distance = stats::KolmogorovDistance(ref, test);
+    const double pKS =
+        ref.empty() || test.empty() ? 0. : stats::KolmogorovProbability(distance, ref.size(), test.size());
+    report.Add("eDep " + det + " KS", distance, 0, pKS, distance, options.ksTolerance);
+
+    std::vector<double> ha, hb;
+    stats::FillHistograms(ref, test, options.bins, ha, hb);
+    double chi2;
+    int ndf;
+    stats::HistogramChi2(ha, hb, chi2, ndf);
+    const double pChi2 = ref.empty() || test.empty() ? 0. : stats::Chi2Probability(chi2, ndf);
+    report.Add("eDep " + det + " chi2", chi2, std::max(ndf, 0), pChi2,
+               stats::RelativeShift(stats::Mean(ref), stats::Mean(test)), options.meanTolerance);
+  }
+
+  void CheckMultiplicity(Report &report, const Options &options, const std::string &det, const Dataset &ref,
+                         const Dataset &test)
+  {
+    std::vector<double> ha, hb;
+    double sumA = 0., sumB = 0.;
+    const auto fill = [&det](const Dataset &dataset, std::vector<double> &histogram, double &sum)
+    {
+      for (const auto &event : dataset.events)
+      {
+        const auto itr = event.second.hits.find(det);
+        const int hits = itr != event.second.hits.end() ? itr->second : 0;
+        if (hits >= static_cast<int>(histogram.size()))
+          histogram.resize(hits + 1);
+        histogram[hits] += 1;
+        sum += hits;
+      }
+    };
+    fill(ref, ha, sumA);
+    fill(test, hb, sumB);
+    ha.resize(std::max(ha.size(), hb.size()));
+    hb.resize(ha.size());
+    double chi2;
+    int ndf;
+    stats::HistogramChi2(ha, hb, chi2, ndf);
+    const double meanA = ref.events.empty() ? 0. : sumA / ref.events.size();
+    const double meanB = test.events.empty() ? 0. : sumB / test.events.size();
+    report.Add("hits/event " + det, chi2, std::max(ndf, 0), stats::Chi2Probability(chi2, ndf),
+               stats::RelativeShift(meanA, meanB), options.meanTolerance);
+  }
+
+  /// Compares the fraction of events with a hit in the detector per bin of
+  /// the event variable
+  void CheckEfficiency(Report &report, const Options &options, const std::string &det, const Dataset &ref,
+                       const Dataset &test, const std::string &variable, double Event::*member)
+  {
+    double lo = HUGE_VAL, hi = -HUGE_VAL;
+    for (const auto *dataset : {&ref, &test})
+    {
+      for (const auto &event : dataset->events)
+      {
+        lo = std::min(lo, event.second.*member);
+        hi = std::max(hi, event.second.*member);
+      }
+    }
+    const double width = std::max(hi - lo, 1e-300) / options.effBins;
+    std::vector<double> nA(options.effBins), kA(options.effBins), nB(options.effBins), kB(options.effBins);
+    const auto fill = [&](const Dataset &dataset, std::vector<double> &n, std::vector<double> &k)
+    {
+      for (const auto &event : dataset.events)
+      {
+        const int bin = std::min(options.effBins - 1, int((event.second.*member - lo) / width));
+        n[bin] += 1;
+        if (event.second.hits.count(det))
+          k[bin] += 1;
+      }
+    };
+    fill(ref, nA, kA);
+    fill(test, nB, kB);
+
+    double chi2 = 0., maxDiff = 0.;
+    int ndf = 0;
+    for (int bin = 0; bin < options.effBins; ++bin)
+    {
+      if (nA[bin] == 0 || nB[bin] == 0)
+        continue;
+      const double pA = kA[bin] / nA[bin], pB = kB[bin] / nB[bin];
+      maxDiff = std::max(maxDiff, std::abs(pA - pB));
+      const double pooled = (kA[bin] + kB[bin]) / (nA[bin] + nB[bin]);
+      if (pooled <= 0. || pooled >= 1.)
+        continue;
+      chi2 += (pA - pB) * (pA - pB) / (pooled * (1. - pooled) * (1. / nA[bin] + 1. / nB[bin]));
+      ++ndf;
+    }
+    report.Add("eff(" + variable + ") " + det, chi2, ndf, stats::Chi2Probability(chi2, ndf), maxDiff,
+               options.effTolerance);
+  }
+
+  void PrintUsage(const char *program)
+  {
+    std::cerr << "Usage: " << program << " <referencePrefix> <testPrefix> [--alpha p] [--bins n] [--eff-bins n]"
+              << " [--ks-tolerance d] [--mean-tolerance r] [--eff-tolerance e] [--report file]" << std::endl;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  Options options;
+  for (int i = 3; i < argc; ++i)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (!std::strcmp(argv[i], "--alpha") && hasValue)
+      options.alpha = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--bins") && hasValue)
+      options.bins = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--eff-bins") && hasValue)
+      options.effBins = std::max(1, std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--ks-tolerance") && hasValue)
+      options.ksTolerance = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--mean-tolerance") && hasValue)
+      options.meanTolerance = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--eff-tolerance") && hasValue)
+      options.effTolerance = std::atof(argv[++i]);
+    else if (!std::strcmp(argv[i], "--report") && hasValue)
+      options.report = argv[++i];
+    else
+    {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  const Dataset reference = ReadDataset(argv[1]);
+  const Dataset test = ReadDataset(argv[2]);
+  if (reference.events.empty() || test.events.empty())
+  {
+    std::cerr << "No events in " << (reference.events.empty() ? argv[1] : argv[2]) << std::endl;
+    return 1;
+  }
+  std::cout << "events: " << reference.events.size() << " reference, " << test.events.size() << " test"
+            << std::endl;
+
+  std::map<std::string, bool> detectors;
+  for (const auto *dataset : {&reference, &test})
+  {
+    for (const auto &spectrum : dataset->spectra)
+      detectors[spectrum.first] = true;
+  }
+  Report report(options);
+  const std::vector<double> empty;
+  for (const auto &det : detectors)
+  {
+    const auto &ref = reference.spectra.count(det.first) ? reference.spectra.at(det.first) : empty;
+    const auto &tst = test.spectra.count(det.first) ? test.spectra.at(det.first) : empty;
+    CheckSpectrum(report, options, det.first, ref, tst);
+    CheckMultiplicity(report, options, det.first, reference, test);
+    CheckEfficiency(report, options, det.first, reference, test, "eProton", &Event::eProton);
+    CheckEfficiency(report, options, det.first, reference, test, "theta", &Event::theta);
+  }
+
+  const std::string summary = report.Summary();
+  std::cout << summary;
+  if (!options.report.empty())
+  {
+    std::ofstream fout(options.report);
+    if (!fout)
+    {
+      std::cerr << "Cannot write " << options.report << std::endl;
+      return 1;
+    }
+    fout << summary;
+  }
+  return report.Passed() ? 0 : 2;
+}